@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <limits>
+
+/**
+ * @brief Allocator returning blocks aligned on a cache line
+ *
+ * Used as the storage allocator of Matrix so every buffer starts on a
+ * 64 bytes boundary and can be walked with aligned SIMD loads
+ */
+template <typename T, size_t Alignment = 64>
+class	AlignedAllocator
+{
+	public:
+		typedef T		value_type;
+
+					template <typename U>
+		struct			rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+					AlignedAllocator(void) noexcept {}
+					template <typename U>
+					AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+		T			*allocate(const size_t& n);
+		void			deallocate(T *pointer, const size_t& n) noexcept { (void)n; ::operator delete(pointer, std::align_val_t(Alignment)); }
+};
+
+template <typename T, size_t Alignment>
+T	*AlignedAllocator<T, Alignment>::allocate(const size_t& n)
+{
+	if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+		throw std::bad_array_new_length();
+	return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+}
+
+template <typename T, typename U, size_t Alignment>
+inline bool	operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return true; }
+
+template <typename T, typename U, size_t Alignment>
+inline bool	operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) { return false; }
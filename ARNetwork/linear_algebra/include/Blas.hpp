@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Dense kernels working on raw row-major buffers of double.
+ *
+ * `ld*` is the distance, in elements, between two consecutive lines of a
+ * buffer (Matrix::getStride()). A transposed operand is read in place, no
+ * transposed copy is ever built.
+ */
+
+// C = alpha * op(A) * op(B) + beta * C with op(A) m x k, op(B) k x n and C m x n
+void	gemm(const bool& trans_a, const bool& trans_b, const size_t& m, const size_t& n, const size_t& k,
+		const double& alpha, const double *a, const size_t& lda, const double *b, const size_t& ldb,
+		const double& beta, double *c, const size_t& ldc);
+
+// y = alpha * op(A) * x + beta * y with A m x n, x and y sized after op(A)
+void	gemv(const bool& trans, const size_t& m, const size_t& n, const double& alpha, const double *a, const size_t& lda,
+		const double *x, const double& beta, double *y);
+
+// A = A + alpha * x * y^T with A m x n
+void	ger(const size_t& m, const size_t& n, const double& alpha, const double *x, const double *y, double *a, const size_t& lda);
+
+// name of the micro-kernel picked at runtime for this CPU ("avx2" or "scalar")
+const char	*gemm_kernel_name(void);
@@ -4,24 +4,40 @@
 #include "Vector.hpp"
 #include "Complex.hpp"
 #include "IdentityMatrix.hpp"
+#include "AlignedAllocator.hpp"
+#include "MatrixRow.hpp"
+#include "Blas.hpp"
 
 class Error;
 
+/**
+ * The coefficients live in one contiguous, 64 bytes aligned, row-major buffer.
+ * Lines of a cache line or more are padded up to a multiple of it (see
+ * stride_for) so that each one starts aligned; the padding is always kept
+ * at T{}. Moving a matrix moves its buffer, the moved-from one must be
+ * assigned before it is used again.
+ */
 template <typename T>
 class	Matrix
 {
 	typedef std::vector<std::vector<T>> vector2;
+	typedef std::vector<T, AlignedAllocator<T>> storage;
 
 	protected:
-		vector2				_matrix;
+		storage				_matrix;
 		size_t				_nbrLines;
 		size_t				_nbrColumns;
+		size_t				_stride;
+
+		static size_t			stride_for(const size_t& nbrColumns);
 	
 	public:
 		virtual				~Matrix(void) {}
-						Matrix(void) : _matrix(), _nbrLines(0), _nbrColumns(0) {}
+						Matrix(void) : _matrix(), _nbrLines(0), _nbrColumns(0), _stride(0) {}
+						Matrix(const Matrix& matrix) = default;
+						Matrix(Matrix&& matrix) = default;
 
-						Matrix(const size_t& nbrLines, const size_t& nbrColumns) : _matrix(vector2(nbrLines, std::vector<T>(nbrColumns, T{}))), _nbrLines(nbrLines), _nbrColumns(nbrColumns) {}
+						Matrix(const size_t& nbrLines, const size_t& nbrColumns) : _matrix(nbrLines * stride_for(nbrColumns), T{}), _nbrLines(nbrLines), _nbrColumns(nbrColumns), _stride(stride_for(nbrColumns)) {}
 						template <typename U>
 						Matrix(const std::initializer_list<std::initializer_list<U>>& list);
 						Matrix(const vector2& vector);
@@ -30,6 +46,8 @@ class	Matrix
 						template <typename U>
 						Matrix(const Matrix<U>& matrix);
 
+		Matrix&				operator=(const Matrix& matrix) = default;
+		Matrix&				operator=(Matrix&& matrix) = default;
 						template <typename U>
 		Matrix<T>&			operator=(const Matrix<U>& matrix);
 						template <typename U>
@@ -38,8 +56,10 @@ class	Matrix
 		Matrix<T>&			operator=(const std::vector<std::vector<U>>& vector);
 						template <typename U>
 		Matrix<T>&			operator=(const Vector<U>& vector);
-		std::vector<T>&			operator[](const size_t& index);
-		const std::vector<T>&		operator[](const size_t& index) const;
+		MatrixRow<T>			operator[](const size_t& index);
+		MatrixRow<const T>		operator[](const size_t& index) const;
+		T&				operator()(const size_t& line, const size_t& column) { return _matrix[line * _stride + column]; }
+		const T&			operator()(const size_t& line, const size_t& column) const { return _matrix[line * _stride + column]; }
 						template <typename U>
 		Matrix<T>			operator*(const Matrix<U>& matrix) const;
 						template <typename U>
@@ -61,6 +81,10 @@ class	Matrix
 
 		const size_t&			getNbrLines(void) const { return _nbrLines; }
 		const size_t&			getNbrColumns(void) const { return _nbrColumns; }
+		const size_t&			getStride(void) const { return _stride; }
+		T				*data(void) { return _matrix.data(); }
+		const T				*data(void) const { return _matrix.data(); }
+		void				resize(const size_t& nbrLines, const size_t& nbrColumns);
 		Vector<T>			getLine(const size_t& index) const;
 		Vector<T>			getColumn(const size_t& index) const;
 		T				determinant(void) const;
@@ -97,6 +121,15 @@ class	Matrix
 template <typename T>
 Matrix<T>	powMatrix(const Matrix<T>& matrix, const size_t& power);
 
+template <typename T>
+void	gemv(const Matrix<T>& matrix, const Vector<T>& x, Vector<T>& y);
+
+template <typename T>
+void	gemv_t(const Matrix<T>& matrix, const Vector<T>& x, Vector<T>& y);
+
+template <typename T>
+void	ger(const Vector<T>& x, const Vector<T>& y, Matrix<T>& matrix, const T& alpha = 1);
+
 #include "../template/Matrix/functions.tpp"
 #include "../template/Matrix/getters.tpp"
 #include "../template/Matrix/operators.tpp"
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <type_traits>
+
+/**
+ * @brief Non owning view over one line of a Matrix
+ *
+ * Returned by Matrix::operator[] so `matrix[i][j]` keeps working on top of
+ * the contiguous storage. The view is only valid while the matrix is alive
+ * and is not resized.
+ */
+template <typename T>
+class	MatrixRow
+{
+	typedef std::remove_const_t<T>	value_type;
+
+	private:
+		T			*_data;
+		size_t			_size;
+
+	public:
+					MatrixRow(T *data, const size_t& size) : _data(data), _size(size) {}
+
+		T&			operator[](const size_t& index) const { return _data[index]; }
+					operator std::vector<value_type>(void) const { return std::vector<value_type>(_data, _data + _size); }
+
+		size_t			size(void) const { return _size; }
+		bool			empty(void) const { return _size == 0; }
+		T			*data(void) const { return _data; }
+		T			*begin(void) const { return _data; }
+		T			*end(void) const { return _data + _size; }
+};
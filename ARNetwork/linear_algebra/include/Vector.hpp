@@ -56,6 +56,8 @@ class	Vector
 		float			norm(void) const;
 		Vector<T>		normalised(void) const;
 		const std::vector<T>&	getStdVector(void) const { return _vector; }
+		T			*data(void) { return _vector.data(); }
+		const T			*data(void) const { return _vector.data(); }
 
 		void			display(void) const;
 		void			normalise(void);
@@ -0,0 +1,335 @@
+#include "../include/Blas.hpp"
+#include "../include/AlignedAllocator.hpp"
+#include <vector>
+#include <algorithm>
+#include <immintrin.h>
+
+/*
+ * Goto-style blocked GEMM.
+ *
+ * op(B) is packed by KC x NC blocks into NR wide column panels and op(A) by
+ * MC x KC blocks into MR high line panels, so the micro-kernel streams both
+ * operands contiguously and keeps the MR x NR tile of C in registers.
+ * Panels are zero padded on the edges, the kernel therefore always runs a
+ * full tile and only the write back is clipped.
+ */
+
+#define MR 6
+#define NR 8
+#define KC 256
+#define MC 72
+#define NC 2048
+
+// below this amount of multiply-adds packing costs more than it saves
+#define SMALL_GEMM 4096
+
+typedef std::vector<double, AlignedAllocator<double>>	buffer;
+typedef void	(*kernel_type)(const size_t&, const double *, const double *, double *, const size_t&, const size_t&, const size_t&);
+typedef void	(*dot_type)(const size_t&, const size_t&, const double *, const size_t&, const double *, double *);
+typedef void	(*axpy_type)(const size_t&, const double&, const double *, double *);
+
+static inline double	coef(const double *x, const size_t& ld, const bool& trans, const size_t& i, const size_t& j)
+{
+	return trans ? x[j * ld + i] : x[i * ld + j];
+}
+
+static void	pack_a(const bool& trans, const size_t& mc, const size_t& kc, const double *a, const size_t& lda, const double& alpha, double *packed)
+{
+	for (size_t i = 0 ; i < mc ; i += MR)
+	{
+		size_t mr = std::min<size_t>(MR, mc - i);
+		for (size_t p = 0 ; p < kc ; p++)
+		{
+			size_t r = 0;
+			for ( ; r < mr ; r++)
+				packed[r] = alpha * coef(a, lda, trans, i + r, p);
+			for ( ; r < MR ; r++)
+				packed[r] = 0;
+			packed += MR;
+		}
+	}
+}
+
+static void	pack_b(const bool& trans, const size_t& kc, const size_t& nc, const double *b, const size_t& ldb, double *packed)
+{
+	for (size_t j = 0 ; j < nc ; j += NR)
+	{
+		size_t nr = std::min<size_t>(NR, nc - j);
+		for (size_t p = 0 ; p < kc ; p++)
+		{
+			if (!trans && nr == NR)
+				std::copy(b + p * ldb + j, b + p * ldb + j + NR, packed);
+			else
+			{
+				size_t c = 0;
+				for ( ; c < nr ; c++)
+					packed[c] = coef(b, ldb, trans, p, j + c);
+				for ( ; c < NR ; c++)
+					packed[c] = 0;
+			}
+			packed += NR;
+		}
+	}
+}
+
+static void	write_back(const double *tile, double *c, const size_t& ldc, const size_t& mr, const size_t& nr)
+{
+	for (size_t i = 0 ; i < mr ; i++)
+		for (size_t j = 0 ; j < nr ; j++)
+			c[i * ldc + j] += tile[i * NR + j];
+}
+
+static void	kernel_scalar(const size_t& kc, const double *a, const double *b, double *c, const size_t& ldc, const size_t& mr, const size_t& nr)
+{
+	double tile[MR * NR] = {};
+	for (size_t p = 0 ; p < kc ; p++)
+	{
+		for (size_t i = 0 ; i < MR ; i++)
+			for (size_t j = 0 ; j < NR ; j++)
+				tile[i * NR + j] += a[i] * b[j];
+		a += MR;
+		b += NR;
+	}
+	write_back(tile, c, ldc, mr, nr);
+}
+
+__attribute__((target("avx2,fma")))
+static void	kernel_avx2(const size_t& kc, const double *a, const double *b, double *c, const size_t& ldc, const size_t& mr, const size_t& nr)
+{
+	__m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+	__m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+	__m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+	__m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+	__m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+	__m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+	for (size_t p = 0 ; p < kc ; p++)
+	{
+		__m256d b0 = _mm256_load_pd(b);
+		__m256d b1 = _mm256_load_pd(b + 4);
+		__m256d ai = _mm256_broadcast_sd(a);
+		c00 = _mm256_fmadd_pd(ai, b0, c00);
+		c01 = _mm256_fmadd_pd(ai, b1, c01);
+		ai = _mm256_broadcast_sd(a + 1);
+		c10 = _mm256_fmadd_pd(ai, b0, c10);
+		c11 = _mm256_fmadd_pd(ai, b1, c11);
+		ai = _mm256_broadcast_sd(a + 2);
+		c20 = _mm256_fmadd_pd(ai, b0, c20);
+		c21 = _mm256_fmadd_pd(ai, b1, c21);
+		ai = _mm256_broadcast_sd(a + 3);
+		c30 = _mm256_fmadd_pd(ai, b0, c30);
+		c31 = _mm256_fmadd_pd(ai, b1, c31);
+		ai = _mm256_broadcast_sd(a + 4);
+		c40 = _mm256_fmadd_pd(ai, b0, c40);
+		c41 = _mm256_fmadd_pd(ai, b1, c41);
+		ai = _mm256_broadcast_sd(a + 5);
+		c50 = _mm256_fmadd_pd(ai, b0, c50);
+		c51 = _mm256_fmadd_pd(ai, b1, c51);
+		a += MR;
+		b += NR;
+	}
+	alignas(32) double tile[MR * NR];
+	_mm256_store_pd(tile, c00); _mm256_store_pd(tile + 4, c01);
+	_mm256_store_pd(tile + 8, c10); _mm256_store_pd(tile + 12, c11);
+	_mm256_store_pd(tile + 16, c20); _mm256_store_pd(tile + 20, c21);
+	_mm256_store_pd(tile + 24, c30); _mm256_store_pd(tile + 28, c31);
+	_mm256_store_pd(tile + 32, c40); _mm256_store_pd(tile + 36, c41);
+	_mm256_store_pd(tile + 40, c50); _mm256_store_pd(tile + 44, c51);
+	write_back(tile, c, ldc, mr, nr);
+}
+
+// out[r] = <a + r * lda, x> for the 4 lines r of a block
+static void	dot4_scalar(const size_t& lines, const size_t& n, const double *a, const size_t& lda, const double *x, double *out)
+{
+	for (size_t r = 0 ; r < lines ; r++)
+	{
+		double sum = 0;
+		for (size_t j = 0 ; j < n ; j++)
+			sum += a[r * lda + j] * x[j];
+		out[r] = sum;
+	}
+}
+
+static void	axpy_scalar(const size_t& n, const double& alpha, const double *x, double *y)
+{
+	for (size_t j = 0 ; j < n ; j++)
+		y[j] += alpha * x[j];
+}
+
+__attribute__((target("avx2,fma")))
+static double	hsum(const __m256d& v)
+{
+	__m128d low = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+__attribute__((target("avx2,fma")))
+static void	dot4_avx2(const size_t& lines, const size_t& n, const double *a, const size_t& lda, const double *x, double *out)
+{
+	if (lines != 4)
+		return dot4_scalar(lines, n, a, lda, x, out);
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+	__m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+	size_t j = 0;
+	for ( ; j + 4 <= n ; j += 4)
+	{
+		__m256d xj = _mm256_loadu_pd(x + j);
+		s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + j), xj, s0);
+		s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + lda + j), xj, s1);
+		s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 2 * lda + j), xj, s2);
+		s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + 3 * lda + j), xj, s3);
+	}
+	out[0] = hsum(s0);
+	out[1] = hsum(s1);
+	out[2] = hsum(s2);
+	out[3] = hsum(s3);
+	for ( ; j < n ; j++)
+		for (size_t r = 0 ; r < 4 ; r++)
+			out[r] += a[r * lda + j] * x[j];
+}
+
+__attribute__((target("avx2,fma")))
+static void	axpy_avx2(const size_t& n, const double& alpha, const double *x, double *y)
+{
+	__m256d a = _mm256_set1_pd(alpha);
+	size_t j = 0;
+	for ( ; j + 8 <= n ; j += 8)
+	{
+		_mm256_storeu_pd(y + j, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + j), _mm256_loadu_pd(y + j)));
+		_mm256_storeu_pd(y + j + 4, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + j + 4), _mm256_loadu_pd(y + j + 4)));
+	}
+	for ( ; j < n ; j++)
+		y[j] += alpha * x[j];
+}
+
+static bool	has_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static kernel_type	select_kernel(void)
+{
+	static const kernel_type kernel = has_avx2() ? kernel_avx2 : kernel_scalar;
+	return kernel;
+}
+
+static dot_type	select_dot(void)
+{
+	static const dot_type dot = has_avx2() ? dot4_avx2 : dot4_scalar;
+	return dot;
+}
+
+static axpy_type	select_axpy(void)
+{
+	static const axpy_type axpy = has_avx2() ? axpy_avx2 : axpy_scalar;
+	return axpy;
+}
+
+const char	*gemm_kernel_name(void)
+{
+	return select_kernel() == kernel_avx2 ? "avx2" : "scalar";
+}
+
+static void	scale(const size_t& m, const size_t& n, const double& beta, double *c, const size_t& ldc)
+{
+	if (beta == 1)
+		return;
+	for (size_t i = 0 ; i < m ; i++)
+	{
+		if (beta == 0)
+			std::fill(c + i * ldc, c + i * ldc + n, 0.0);
+		else
+			for (size_t j = 0 ; j < n ; j++)
+				c[i * ldc + j] *= beta;
+	}
+}
+
+static void	gemm_small(const bool& trans_a, const bool& trans_b, const size_t& m, const size_t& n, const size_t& k,
+		const double& alpha, const double *a, const size_t& lda, const double *b, const size_t& ldb, double *c, const size_t& ldc)
+{
+	for (size_t i = 0 ; i < m ; i++)
+	{
+		double *line = c + i * ldc;
+		for (size_t p = 0 ; p < k ; p++)
+		{
+			double coefficient = alpha * coef(a, lda, trans_a, i, p);
+			if (trans_b)
+				for (size_t j = 0 ; j < n ; j++)
+					line[j] += coefficient * b[j * ldb + p];
+			else
+				for (size_t j = 0 ; j < n ; j++)
+					line[j] += coefficient * b[p * ldb + j];
+		}
+	}
+}
+
+void	gemm(const bool& trans_a, const bool& trans_b, const size_t& m, const size_t& n, const size_t& k,
+		const double& alpha, const double *a, const size_t& lda, const double *b, const size_t& ldb,
+		const double& beta, double *c, const size_t& ldc)
+{
+	scale(m, n, beta, c, ldc);
+	if (m == 0 || n == 0 || k == 0 || alpha == 0)
+		return;
+	if (m * n * k <= SMALL_GEMM)
+		return gemm_small(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, c, ldc);
+	kernel_type kernel = select_kernel();
+	thread_local buffer packed_a(MC * KC);
+	thread_local buffer packed_b(KC * NC);
+	for (size_t jc = 0 ; jc < n ; jc += NC)
+	{
+		size_t nc = std::min<size_t>(NC, n - jc);
+		for (size_t pc = 0 ; pc < k ; pc += KC)
+		{
+			size_t kc = std::min<size_t>(KC, k - pc);
+			pack_b(trans_b, kc, nc, trans_b ? b + jc * ldb + pc : b + pc * ldb + jc, ldb, packed_b.data());
+			for (size_t ic = 0 ; ic < m ; ic += MC)
+			{
+				size_t mc = std::min<size_t>(MC, m - ic);
+				pack_a(trans_a, mc, kc, trans_a ? a + pc * lda + ic : a + ic * lda + pc, lda, alpha, packed_a.data());
+				for (size_t jr = 0 ; jr < nc ; jr += NR)
+				{
+					for (size_t ir = 0 ; ir < mc ; ir += MR)
+						kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc,
+							c + (ic + ir) * ldc + jc + jr, ldc, std::min<size_t>(MR, mc - ir), std::min<size_t>(NR, nc - jr));
+				}
+			}
+		}
+	}
+}
+
+void	gemv(const bool& trans, const size_t& m, const size_t& n, const double& alpha, const double *a, const size_t& lda,
+		const double *x, const double& beta, double *y)
+{
+	size_t size_y = trans ? n : m;
+	if (beta == 0)
+		std::fill(y, y + size_y, 0.0);
+	else if (beta != 1)
+		for (size_t i = 0 ; i < size_y ; i++)
+			y[i] *= beta;
+	if (alpha == 0)
+		return;
+	if (trans)
+	{
+		axpy_type axpy = select_axpy();
+		for (size_t i = 0 ; i < m ; i++)
+			axpy(n, alpha * x[i], a + i * lda, y);
+		return;
+	}
+	dot_type dot = select_dot();
+	double out[4];
+	for (size_t i = 0 ; i < m ; i += 4)
+	{
+		size_t lines = std::min<size_t>(4, m - i);
+		dot(lines, n, a + i * lda, lda, x, out);
+		for (size_t r = 0 ; r < lines ; r++)
+			y[i + r] += alpha * out[r];
+	}
+}
+
+void	ger(const size_t& m, const size_t& n, const double& alpha, const double *x, const double *y, double *a, const size_t& lda)
+{
+	axpy_type axpy = select_axpy();
+	for (size_t i = 0 ; i < m ; i++)
+		if (x[i] != 0)
+			axpy(n, alpha * x[i], y, a + i * lda);
+}
@@ -7,7 +7,7 @@ DiffMatrix::DiffMatrix(const size_t& dimension) : Matrix<float>(dimension, dimen
 		for (size_t j = i + 1 ; j < _dimension ; j++)
 		{
 			if (i == j - 1)
-				_matrix[i][j] = j;
+				(*this)(i, j) = j;
 		}
 	}
 }
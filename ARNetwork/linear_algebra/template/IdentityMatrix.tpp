@@ -8,9 +8,9 @@ IdentityMatrix<T>::IdentityMatrix(const size_t& dimension) : Matrix<T>(dimension
 		for (size_t j = 0 ; j < _dimension ; j++)
 		{
 			if (i == j)
-				this->_matrix[i][j] = 1;
+				(*this)(i, j) = 1;
 			else
-				this->_matrix[i][j] = 0;
+				(*this)(i, j) = 0;
 		}
 	}
 }
@@ -3,11 +3,11 @@
 
 template <typename T>
 template <typename U>
-Matrix<T>::Matrix(const Vector<U>& vector) : _nbrLines(vector.dimension()), _nbrColumns(1)
+Matrix<T>::Matrix(const Vector<U>& vector) : _nbrLines(vector.dimension()), _nbrColumns(1), _stride(1)
 {
 	if (vector.empty())
 		throw Error("Error: vector is empty");
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
@@ -15,12 +15,12 @@ Matrix<T>::Matrix(const Vector<U>& vector) : _nbrLines(vector.dimension()), _nbr
 			if constexpr (std::is_same<U, Complex>::value)
 			{
 				if constexpr (std::is_same<T, Complex>::value)
-					_matrix[i][j] = vector[i];
+					(*this)(i, j) = vector[i];
 				else
-					_matrix[i][j] = static_cast<float>(vector[i].getRealPart());
+					(*this)(i, j) = static_cast<float>(vector[i].getRealPart());
 			}
 			else
-				_matrix[i][j] = static_cast<float>(vector[i]);
+				(*this)(i, j) = static_cast<float>(vector[i]);
 		}
 	}
 }
@@ -33,15 +33,15 @@ Matrix<T>::Matrix(const Matrix<U>& matrix)
 		throw Error("Error: matrix is empty");
 	_nbrLines = matrix.getNbrLines();
 	_nbrColumns = matrix.getNbrColumns();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
 		{
 			if constexpr (std::is_same<U, Complex>::value && !std::is_same<T, Complex>::value)
-				_matrix[i][j] = matrix[i][j].getRealPart();
+				(*this)(i, j) = matrix[i][j].getRealPart();
 			else
-				_matrix[i][j] = matrix[i][j];
+				(*this)(i, j) = matrix[i][j];
 		}
 	}
 }
@@ -55,9 +55,7 @@ Matrix<T>::Matrix(const std::initializer_list<std::initializer_list<U>>& list)
 			throw Error("Error : initializers must have the same dimensions");
 	_nbrLines = list.size();
 	_nbrColumns = list.begin()->size();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
-	_matrix.clear();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	size_t i = 0;
 	for (const auto& datas : list)
 	{
@@ -67,12 +65,12 @@ Matrix<T>::Matrix(const std::initializer_list<std::initializer_list<U>>& list)
 			if constexpr (std::is_same<U, Complex>::value)
 			{
 				if constexpr (std::is_same<T, Complex>::value)
-					_matrix[i][j] = data;
+					(*this)(i, j) = data;
 				else
-					_matrix[i][j] = static_cast<float>(data.getRealPart());
+					(*this)(i, j) = static_cast<float>(data.getRealPart());
 			}
 			else
-				_matrix[i][j] = static_cast<float>(data);
+				(*this)(i, j) = static_cast<float>(data);
 			j++;
 		}
 		i++;
@@ -87,8 +85,38 @@ Matrix<T>::Matrix(const vector2& vector)
 			throw Error("Error : vectors must have the same dimensions");
 	_nbrLines = vector.size();
 	_nbrColumns = vector[0].size();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
-	_matrix.clear();
+	resize(_nbrLines, _nbrColumns);
 	for (size_t i = 0 ; i < _nbrLines ; i++)
-		_matrix.emplace_back(vector[i]);
+		std::copy(vector[i].begin(), vector[i].end(), _matrix.begin() + i * _stride);
+}
+
+/**
+ * @brief Distance between the starts of two lines of @param nbrColumns
+ *
+ * Lines shorter than a cache line aren't padded: a 2 columns matrix of
+ * double would take 4 times its size. Longer ones are padded up to the
+ * next multiple of a cache line, less than one line of padding each.
+ */
+template <typename T>
+size_t	Matrix<T>::stride_for(const size_t& nbrColumns)
+{
+	constexpr size_t lanes = sizeof(T) < 64 && 64 % sizeof(T) == 0 ? 64 / sizeof(T) : 1;
+	if (nbrColumns < lanes)
+		return nbrColumns;
+	return (nbrColumns + lanes - 1) / lanes * lanes;
+}
+
+/**
+ * @brief Give the matrix new dimensions, every coefficient is reset to T{}
+ * 
+ * The underlying buffer is only reallocated when it is too small, so a
+ * matrix can be reshaped in a loop without touching the heap
+ */
+template <typename T>
+void	Matrix<T>::resize(const size_t& nbrLines, const size_t& nbrColumns)
+{
+	_nbrLines = nbrLines;
+	_nbrColumns = nbrColumns;
+	_stride = stride_for(nbrColumns);
+	_matrix.assign(_nbrLines * _stride, T{});
 }
\ No newline at end of file
@@ -6,8 +6,8 @@ template <typename T>
 void	Matrix<T>::display(void) const
 {
 	std::cout << "[\n";
-	for (const auto& data : _matrix)
-		Vector<T>(data).display();
+	for (size_t i = 0 ; i < _nbrLines ; i++)
+		Vector<T>(std::vector<T>((*this)[i])).display();
 	std::cout << "]\n";
 }
 
@@ -22,9 +22,9 @@ bool	Matrix<T>::diagonal(void) const
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
 		{
-			if (i != j && _matrix[i][j])
+			if (i != j && (*this)(i, j))
 				return false;
-			if (i == j && _matrix[i][j] == 0)
+			if (i == j && (*this)(i, j) == 0)
 				return false;
 		}
 	}
@@ -118,9 +118,7 @@ void	Matrix<T>::switchLine(const size_t& l1, const size_t& l2)
 		throw Error("Error : l1 out of range");
 	if (l2 > getNbrLines() - 1)
 		throw Error("Error : l2 out of range");
-	Vector<T> tmp(getLine(l1));
-	_matrix[l1] = _matrix[l2];
-	_matrix[l2] = tmp.getStdVector();
+	std::swap_ranges(_matrix.begin() + l1 * _stride, _matrix.begin() + l1 * _stride + _nbrColumns, _matrix.begin() + l2 * _stride);
 }
 
 template <typename T>
@@ -134,7 +132,7 @@ bool	Matrix<T>::upperTriangle(void) const
 	{
 		for (size_t j = 0 ; j < getNbrColumns() ; j++)
 		{
-			if (i > j && (_matrix[i][j] < -1e-10 || _matrix[i][j] > 1e-10))
+			if (i > j && ((*this)(i, j) < -1e-10 || (*this)(i, j) > 1e-10))
 				return false;
 		}
 	}
@@ -152,7 +150,7 @@ bool	Matrix<T>::lowerTriangle(void) const
 	{
 		for (size_t j = 0 ; j < getNbrColumns() ; j++)
 		{
-			if (i < j && _matrix[i][j] != T{})
+			if (i < j && (*this)(i, j) != T{})
 				return false;
 		}
 	}
@@ -174,8 +172,8 @@ void	Matrix<T>::switchColumn(const size_t& c1, const size_t& c2)
 	std::vector<T> v2(getColumn(c2).getStdVector());
 	for (size_t i = 0 ; i < getNbrLines() ; i++)
 	{
-		_matrix[i][c2] = v1[i];
-		_matrix[i][c1] = v2[i];
+		(*this)(i, c2) = v1[i];
+		(*this)(i, c1) = v2[i];
 	}
 }
 
@@ -184,9 +182,9 @@ bool	Matrix<T>::null(void) const
 {
 	if (empty())
 		throw Error("Error: matrix is empty");
-	for (const auto& datas : _matrix)
+	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
-		for (const auto& data : datas)
+		for (const auto& data : (*this)[i])
 		{
 			if (data > 1e-5 || data < -1e-5)
 				return false;
@@ -225,7 +223,7 @@ T	Matrix<T>::trace(void) const
 		throw Error("Error: matrix must be square");
 	T result{};
 	for (size_t i = 0 ; i < getNbrColumns() ; i++)
-		result += _matrix[i][i];
+		result += (*this)(i, i);
 	return result;
 }
 
@@ -349,14 +347,14 @@ T	Matrix<T>::determinant(void) const
 	{
 		T result = pow(-1, swap);
 		for (size_t i = 0 ; i < getNbrColumns() ; i++)
-			result *= _matrix[i][i];
+			result *= (*this)(i, i);
 		swap = 0;
 		return result;
 	}
 	if (getNbrColumns() == 1)
-		return _matrix[0][0];
+		return (*this)(0, 0);
 	else if (getNbrLines() == 2)
-		return _matrix[0][0] * _matrix[1][1] - _matrix[0][1] * _matrix[1][0];
+		return (*this)(0, 0) * (*this)(1, 1) - (*this)(0, 1) * (*this)(1, 0);
 	else if (getNbrLines() == 3)
 		return determinant3(*this);
 	else
@@ -375,10 +373,10 @@ Matrix<T>	Matrix<T>::inverse(void) const
 	if (getNbrColumns() == 2)
 	{
 		Matrix<T> result(getNbrLines(), getNbrColumns());
-		result[0][0] = _matrix[1][1];
-		result[1][1] = _matrix[0][0];
-		result[0][1] = _matrix[0][1] * -1;
-		result[1][0] = _matrix[1][0] * -1;
+		result[0][0] = (*this)(1, 1);
+		result[1][1] = (*this)(0, 0);
+		result[0][1] = (*this)(0, 1) * -1;
+		result[1][0] = (*this)(1, 0) * -1;
 		return result * (Complex(1) / determinant());
 	}
 	else
@@ -394,7 +392,7 @@ Matrix<T>	Matrix<T>::transpose(void) const
 	for (size_t i = 0 ; i < getNbrLines() ; i++)
 	{
 		for (size_t j = 0 ; j < getNbrColumns() ; j++)
-			result[j][i] = _matrix[i][j];
+			result[j][i] = (*this)(i, j);
 	}
 	return result;
 }
@@ -421,7 +419,7 @@ Matrix<T>	Matrix<T>::comatrix(void) const
 				{
 					if (k != i && l != j)
 					{
-						lowMatrix[x / (getNbrColumns() - 1)][x % (getNbrColumns() - 1)] = _matrix[k][l];
+						lowMatrix[x / (getNbrColumns() - 1)][x % (getNbrColumns() - 1)] = (*this)(k, l);
 						x++;
 					}
 				}
@@ -443,8 +441,8 @@ std::vector<Complex>	Matrix<T>::eigenValues(void) const
 	if (getNbrColumns() == 2)
 	{
 		T a = 1;
-		T b = -_matrix[0][0] - _matrix[1][1];
-		T c = _matrix[0][0] * _matrix[1][1] - _matrix[0][1] * _matrix[1][0];
+		T b = -(*this)(0, 0) - (*this)(1, 1);
+		T c = (*this)(0, 0) * (*this)(1, 1) - (*this)(0, 1) * (*this)(1, 0);
 		T delta = pow(b, 2) - 4 * a * c;
 		if (delta < 0)
 		{
@@ -486,7 +484,7 @@ std::vector<Vector<Complex>>	Matrix<T>::eigenVectors(void) const
 	for (const auto& eigenValue : eigenvalues)
 	{
 		Vector<Complex> eigenVector(2);
-		eigenVector[0] = Complex(-_matrix[0][1]) / (Complex(_matrix[0][0]) - eigenValue);
+		eigenVector[0] = Complex(-(*this)(0, 1)) / (Complex((*this)(0, 0)) - eigenValue);
 		eigenVector[1] = 1;
 		eigenVectors.push_back(eigenVector.normalised());
 	}
@@ -501,7 +499,7 @@ Matrix<T>	Matrix<T>::sumCols(void) const
 	{
 		T nbr{};
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
-			nbr += _matrix[i][j];
+			nbr += (*this)(i, j);
 		result[i][0] = nbr;
 	}
 	return result;
@@ -515,7 +513,7 @@ Matrix<T>	Matrix<T>::sumLines(void) const
 	{
 		T nbr{};
 		for (size_t j = 0 ; j < _nbrLines ; j++)
-			nbr += _matrix[j][i];
+			nbr += (*this)(j, i);
 		result[0][i] = nbr;
 	}
 	return result;
@@ -546,4 +544,82 @@ Matrix<T>	Matrix<T>::hadamard(const Matrix<T>& matrix) const
 			result[i][j] *= matrix[i][j];
 	}
 	return result;
+}
+
+/**
+ * @brief Compute y = matrix * x without building any temporary
+ * 
+ * y is only reallocated when its dimension doesn't match the number of lines
+ */
+template <typename T>
+void	gemv(const Matrix<T>& matrix, const Vector<T>& x, Vector<T>& y)
+{
+	if (matrix.empty() || x.empty())
+		throw Error("Error: matrix or vector is empty");
+	if (matrix.getNbrColumns() != x.dimension())
+		throw Error("Error: vector.dimension must be equal to matrix.columns");
+	if (y.dimension() != matrix.getNbrLines())
+		y = Vector<T>(matrix.getNbrLines());
+	if constexpr (std::is_same<T, double>::value)
+		gemv(false, matrix.getNbrLines(), matrix.getNbrColumns(), 1.0, matrix.data(), matrix.getStride(), x.data(), 0.0, y.data());
+	else
+	{
+		for (size_t i = 0 ; i < matrix.getNbrLines() ; i++)
+		{
+			T sum{};
+			for (size_t j = 0 ; j < matrix.getNbrColumns() ; j++)
+				sum += matrix(i, j) * x[j];
+			y[i] = sum;
+		}
+	}
+}
+
+/**
+ * @brief Compute y = transpose(matrix) * x reading the matrix in place
+ * 
+ * y is only reallocated when its dimension doesn't match the number of columns
+ */
+template <typename T>
+void	gemv_t(const Matrix<T>& matrix, const Vector<T>& x, Vector<T>& y)
+{
+	if (matrix.empty() || x.empty())
+		throw Error("Error: matrix or vector is empty");
+	if (matrix.getNbrLines() != x.dimension())
+		throw Error("Error: vector.dimension must be equal to matrix.lines");
+	if (y.dimension() != matrix.getNbrColumns())
+		y = Vector<T>(matrix.getNbrColumns());
+	if constexpr (std::is_same<T, double>::value)
+		gemv(true, matrix.getNbrLines(), matrix.getNbrColumns(), 1.0, matrix.data(), matrix.getStride(), x.data(), 0.0, y.data());
+	else
+	{
+		for (size_t j = 0 ; j < matrix.getNbrColumns() ; j++)
+			y[j] = T{};
+		for (size_t i = 0 ; i < matrix.getNbrLines() ; i++)
+			for (size_t j = 0 ; j < matrix.getNbrColumns() ; j++)
+				y[j] += matrix(i, j) * x[i];
+	}
+}
+
+/**
+ * @brief Add alpha * x * transpose(y) to the matrix (rank 1 update)
+ * 
+ * An empty matrix is first sized to x.dimension * y.dimension
+ */
+template <typename T>
+void	ger(const Vector<T>& x, const Vector<T>& y, Matrix<T>& matrix, const T& alpha)
+{
+	if (x.empty() || y.empty())
+		throw Error("Error: vector is empty");
+	if (matrix.empty())
+		matrix.resize(x.dimension(), y.dimension());
+	if (matrix.getNbrLines() != x.dimension() || matrix.getNbrColumns() != y.dimension())
+		throw Error("Error: matrix dimensions must be x.dimension * y.dimension");
+	if constexpr (std::is_same<T, double>::value)
+		ger(x.dimension(), y.dimension(), alpha, x.data(), y.data(), matrix.data(), matrix.getStride());
+	else
+	{
+		for (size_t i = 0 ; i < x.dimension() ; i++)
+			for (size_t j = 0 ; j < y.dimension() ; j++)
+				matrix(i, j) += alpha * x[i] * y[j];
+	}
 }
\ No newline at end of file
@@ -8,7 +8,7 @@ Vector<T>	Matrix<T>::getLine(const size_t& index) const
 		throw Error("Error: matrix is empty");
 	if (index > getNbrLines() - 1)
 		throw Error("Error : index out of range");
-	return Vector<T>(_matrix[index]);
+	return Vector<T>(std::vector<T>(_matrix.begin() + index * _stride, _matrix.begin() + index * _stride + _nbrColumns));
 }
 
 template <typename T>
@@ -20,6 +20,6 @@ Vector<T>	Matrix<T>::getColumn(const size_t& index) const
 		throw Error("Error : index out of range");
 	Vector<T> result(getNbrLines());
 	for (size_t i = 0 ; i < getNbrLines() ; i++)
-		result[i] = _matrix[i][index];
+		result[i] = (*this)(i, index);
 	return result;
 }
\ No newline at end of file
@@ -9,9 +9,7 @@ Matrix<T>&	Matrix<T>::operator=(const Matrix<U>& matrix)
 		throw Error("Error: matrix is empty");
 	if (reinterpret_cast<const void *>(this) != reinterpret_cast<const void *>(&matrix))
 	{
-		_nbrLines = matrix.getNbrLines();
-		_nbrColumns = matrix.getNbrColumns();
-		_matrix = std::vector<std::vector<T>>(matrix.getNbrLine(), std::vector<T>(matrix.getNbrColumns()));
+		resize(matrix.getNbrLines(), matrix.getNbrColumns());
 		for (size_t i = 0 ; i < _nbrLines ; i++)
 		{
 			for (size_t j = 0 ; j < _nbrColumns ; j++)
@@ -19,12 +17,12 @@ Matrix<T>&	Matrix<T>::operator=(const Matrix<U>& matrix)
 				if constexpr (std::is_same<U, Complex>::value)
 				{
 					if constexpr (std::is_same<T, Complex>::value)
-						_matrix[i][j] = matrix[i][j];
+						(*this)(i, j) = matrix[i][j];
 					else
-						_matrix[i][j] = static_cast<float>(matrix[i][j].getRealPart());
+						(*this)(i, j) = static_cast<float>(matrix[i][j].getRealPart());
 				}
 				else
-					_matrix[i][j] = static_cast<float>(matrix[i][j]);
+					(*this)(i, j) = static_cast<float>(matrix[i][j]);
 			}
 		}
 	}
@@ -42,7 +40,7 @@ Matrix<T>&	Matrix<T>::operator=(const std::initializer_list<std::initializer_lis
 			throw Error("Error : initializers must have the same dimensions");
 	_nbrLines = list.size();
 	_nbrColumns = list.begin()->size();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	size_t i = 0;
 	for (const auto& datas : list)
 	{
@@ -52,12 +50,12 @@ Matrix<T>&	Matrix<T>::operator=(const std::initializer_list<std::initializer_lis
 			if constexpr (std::is_same<U, Complex>::value)
 			{
 				if constexpr (std::is_same<T, Complex>::value)
-					_matrix[i][j] = data;
+					(*this)(i, j) = data;
 				else
-					_matrix[i][j] = static_cast<float>(data.getRealPart());
+					(*this)(i, j) = static_cast<float>(data.getRealPart());
 			}
 			else
-				_matrix[i][j] = static_cast<float>(data);
+				(*this)(i, j) = static_cast<float>(data);
 			j++;
 		}
 		i++;
@@ -76,7 +74,7 @@ Matrix<T>&	Matrix<T>::operator=(const std::vector<std::vector<U>>& vector)
 			throw Error("Error : vectors must have the same dimensions");
 	_nbrLines = vector.size();
 	_nbrColumns = vector[0].size();
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
@@ -84,12 +82,12 @@ Matrix<T>&	Matrix<T>::operator=(const std::vector<std::vector<U>>& vector)
 			if constexpr (std::is_same<U, Complex>::value)
 			{
 				if constexpr (std::is_same<T, Complex>::value)
-					_matrix[i][j] = vector[i][j];
+					(*this)(i, j) = vector[i][j];
 				else
-					_matrix[i][j] = static_cast<float>(vector[i][j].getRealPart());
+					(*this)(i, j) = static_cast<float>(vector[i][j].getRealPart());
 			}
 			else
-				_matrix[i][j] = static_cast<float>(vector[i][j]);
+				(*this)(i, j) = static_cast<float>(vector[i][j]);
 		}
 	}
 	return *this;
@@ -103,7 +101,7 @@ Matrix<T>&	Matrix<T>::operator=(const Vector<U>& vector)
 		throw Error("Error: vector is empty");
 	_nbrLines = vector.dimension();
 	_nbrColumns = 1;
-	_matrix = std::vector<std::vector<T>>(_nbrLines, std::vector<T>(_nbrColumns));
+	resize(_nbrLines, _nbrColumns);
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
@@ -111,35 +109,35 @@ Matrix<T>&	Matrix<T>::operator=(const Vector<U>& vector)
 			if constexpr (std::is_same<U, Complex>::value)
 			{
 				if constexpr (std::is_same<T, Complex>::value)
-					_matrix[i][j] = vector[i];
+					(*this)(i, j) = vector[i];
 				else
-					_matrix[i][j] = static_cast<float>(vector[i].getRealPart());
+					(*this)(i, j) = static_cast<float>(vector[i].getRealPart());
 			}
 			else
-				_matrix[i][j] = static_cast<float>(vector[i]);
+				(*this)(i, j) = static_cast<float>(vector[i]);
 		}
 	}
 	return *this;
 }
 
 template <typename T>
-std::vector<T>&	Matrix<T>::operator[](const size_t& index)
+MatrixRow<T>	Matrix<T>::operator[](const size_t& index)
 {
 	if (empty())
 		throw Error("Error: matrix is empty");
 	if (index > _nbrLines - 1)
 		throw Error("Error : index out of range");
-	return _matrix[index];
+	return MatrixRow<T>(_matrix.data() + index * _stride, _nbrColumns);
 }
 
 template <typename T>
-const std::vector<T>&	Matrix<T>::operator[](const size_t& index) const
+MatrixRow<const T>	Matrix<T>::operator[](const size_t& index) const
 {
 	if (empty())
 		throw Error("Error: matrix is empty");
 	if (index > _nbrLines - 1)
 		throw Error("Error : index out of range");
-	return _matrix[index];
+	return MatrixRow<const T>(_matrix.data() + index * _stride, _nbrColumns);
 }
 
 template <typename T>
@@ -148,11 +146,18 @@ Matrix<T>	Matrix<T>::operator*(const Matrix<U>& matrix) const
 {
 	if (empty() || matrix.empty())
 		throw Error("Error: matrix is empty");
+	if (_nbrColumns != matrix.getNbrLines())
+		throw Error("Error : matrices dimensions are not compatible");
 	Matrix<T> result(_nbrLines, matrix.getNbrColumns());
-	for (size_t i = 0 ; i < result._nbrLines ; i++)
+	if constexpr (std::is_same<T, double>::value && std::is_same<U, double>::value)
+		gemm(false, false, _nbrLines, matrix.getNbrColumns(), _nbrColumns, 1.0, data(), _stride, matrix.data(), matrix.getStride(), 0.0, result.data(), result.getStride());
+	else
 	{
-		for (size_t j = 0 ; j < result._nbrColumns ; j++)
-			result[i][j] = dotProduct<T>(getLine(i), matrix.getColumn(j));
+		for (size_t i = 0 ; i < result._nbrLines ; i++)
+		{
+			for (size_t j = 0 ; j < result._nbrColumns ; j++)
+				result[i][j] = dotProduct<T>(getLine(i), matrix.getColumn(j));
+		}
 	}
 	return result;
 }
@@ -162,11 +167,8 @@ Matrix<T>&	Matrix<T>::operator*=(const float& number)
 {
 	if (empty())
 		throw Error("Error: matrix is empty");
-	for (auto& datas : _matrix)
-	{
-		for (auto& data : datas)
-			data *= number;
-	}
+	for (auto& data : _matrix)
+		data *= number;
 	return *this;
 }
 
@@ -179,7 +181,7 @@ Matrix<T>	Matrix<T>::operator*(const float& number) const
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
-			result[i][j] = _matrix[i][j] * number;
+			result[i][j] = (*this)(i, j) * number;
 	}
 	return result;
 }
@@ -219,7 +221,7 @@ bool	Matrix<T>::operator==(const Matrix<U>& matrix) const
 	{
 		for (size_t j = 0 ; j < getNbrColumns() ; j++)
 		{
-			if (_matrix[i][j] != matrix[i][j])
+			if ((*this)(i, j) != matrix[i][j])
 				return false;
 		}
 	}
@@ -240,7 +242,7 @@ Matrix<T>	Matrix<T>::operator+(const Matrix<U>& matrix) const
 	for (size_t i = 0 ; i < result._nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < result._nbrColumns ; j++)
-			result[i][j] = _matrix[i][j] + matrix[i][j];
+			result[i][j] = (*this)(i, j) + matrix[i][j];
 	}
 	return result;
 }
@@ -259,7 +261,7 @@ Matrix<T>	Matrix<T>::operator-(const Matrix<U>& matrix) const
 	for (size_t i = 0 ; i < result._nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < result._nbrColumns ; j++)
-			result[i][j] = _matrix[i][j] - matrix[i][j];
+			result[i][j] = (*this)(i, j) - matrix[i][j];
 	}
 	return result;
 }
@@ -273,7 +275,7 @@ Matrix<Complex>	Matrix<T>::operator*(const Complex& complex) const
 	for (size_t i = 0 ; i < _nbrLines ; i++)
 	{
 		for (size_t j = 0 ; j < _nbrColumns ; j++)
-			result[i][j] = complex * _matrix[i][j];
+			result[i][j] = complex * (*this)(i, j);
 	}
 	return result;
 }
\ No newline at end of file
@@ -3,16 +3,25 @@
 #include "../../linear_algebra/include/LinearAlgebra.hpp"
 #include "Json.hpp"
 #include "Functions.hpp"
+#include "Workspace.hpp"
+#include "Allocations.hpp"
+#include "ThreadPool.hpp"
+#include "Dataset.hpp"
+#include "DataSource.hpp"
+#include "Checkpoint.hpp"
 #include <random>
 #include <cmath>
 #include <algorithm>
 #include <fstream>
+#include <numeric>
+#include <memory>
+
+class	ModelFile;
 
 class	ARNetwork
 {
 	private:
-		using batch_type = std::vector<std::vector<std::vector<double>>>;
-		using model_measures_type = std::pair<std::map<size_t, std::pair<double, double>>, std::map<size_t, std::pair<double, double>>>;
+		using model_measures_type = TrainingHistory;
 
 		Vector<double>				_inputs;
 		Vector<double>				_outputs;
@@ -20,13 +29,39 @@ class	ARNetwork
 		std::vector<Vector<double>>		_z;
 		std::vector<Vector<double>>		_a;
 		std::vector<Vector<double>>		_bias;
+		Workspace				_workspace;
+		std::vector<Workspace>			_replicas;
+		std::vector<std::pair<double, double>>	_partials;
+		std::vector<size_t>			_order;
+		bool					_shuffle;
+		std::mt19937				*_urng;
+		std::mt19937				_saved_urng;	// state of the generator of a loaded checkpoint
+		bool					_has_saved_urng;
+		size_t					_steady_state_allocations;
+		size_t					_epoch;
+		model_measures_type			_history;
+		CheckpointSettings			_checkpoint;
 		double					_learning_rate;
 		std::string				_layer_function;
 		std::string				_output_function;
 		std::string				_loss_function;
+		Activation				_layer_activation;
+		Activation				_output_activation;
+		Loss					_loss_activation;
 
-		void					process(const batch_type& inputs, const batch_type& outputs,
-							const double& sstot, std::map<size_t, std::pair<double, double>>& track_training, const size_t& epoch, const bool& back);
+		Workspace&				replica(const size_t& index) { return index == 0 ? _workspace : _replicas[index - 1]; }
+		void					forward(Workspace& workspace);
+		void					backward(Workspace& workspace, std::vector<Matrix<double>>& dW, std::vector<Matrix<double>>& dZ, const Matrix<double>& y);
+		void					reduce_gradients(ThreadPool& pool, const size_t& slices);
+		void					reserve_training(const size_t& threads, const size_t& batch);
+		void					process(ThreadPool& pool, const DatasetView& datas, const size_t *order, const size_t& size,
+							const size_t& batch, const bool& back, double& loss_index, double& ssres);
+		model_measures_type			fit(ThreadPool& pool, const DatasetView& training, const size_t *training_rows, const size_t& training_size,
+							const DatasetView& validation, const size_t *validation_rows, const size_t& validation_size, const size_t& batch, const size_t& epochs);
+		std::pair<double, double>		stream(ThreadPool& pool, ChunkReader& reader, IDataSource& source, const size_t& batch, const bool& back);
+		void					load(const ModelFile& model);
+		std::unique_ptr<Checkpointer>		start_checkpoints(void) const;
+		void					end_epoch(Checkpointer *checkpointer);
 	public:
 							ARNetwork(const std::vector<size_t>& network);
 							ARNetwork(const std::string& file_name);
@@ -46,6 +81,7 @@ class	ARNetwork
 							throw Error("Error: index out of range"); else return _bias[index]; }
 		const double&				get_bias(const size_t& i, const size_t& j) const;
 		const double&				get_learning_rate(void) const { return _learning_rate; }
+		const bool&				get_shuffle(void) const { return _shuffle; }
 		const Vector<double>&			get_outputs(void) const { return _outputs; }
 		const double&				get_output(const size_t& index) { if (index > _outputs.dimension() - 1)
 							throw Error("Error: index out of range"); else return _outputs[index]; }
@@ -57,6 +93,13 @@ class	ARNetwork
 							throw Error("Error: index out of range"); else return _weights[layer].getNbrLines(); }
 		size_t					nbr_bias(void) const { return _bias.size(); }
 		size_t					size_outputs(void) const { return _outputs.dimension(); }
+		std::vector<size_t>			topology(void) const;
+		const size_t&				steady_state_allocations(void) const { return _steady_state_allocations; }
+		// number of epochs trained, and the measures of each, saved in checkpoints
+		const size_t&				get_epoch(void) const { return _epoch; }
+		const TrainingHistory&			get_history(void) const { return _history; }
+		const std::mt19937&			get_urng(void) const { return *_urng; }
+		void					save_checkpoint(const std::string& file_name) const;
 
 		void					set_inputs(const Vector<double>& inputs) { _inputs = inputs; }
 		void					set_weights(std::vector<Matrix<double>>& weights) { _weights = weights; }
@@ -67,16 +110,38 @@ class	ARNetwork
 							{ if (index > _bias.size() - 1) throw Error("Error: index out of range"); else _bias[index] = bias; }
 		void					set_bias(const size_t& i, const size_t& j, const double& bias);
 		void					set_learning_rate(const double& learning_rate) { _learning_rate = learning_rate; }
+		void					set_shuffle(const bool& shuffle) { _shuffle = shuffle; }
+		// generator the training order is drawn from, it must outlive the training
+		void					set_urng(std::mt19937& urng) { _urng = &urng; }
+		// go on drawing from the generator saved in the loaded checkpoint, false if it had none
+		bool					restore_urng(void) { if (_has_saved_urng) _urng = &_saved_urng; return _has_saved_urng; }
+		// save the training state while train runs, see Checkpointer; not copied with the network
+		void					set_checkpoint(const CheckpointSettings& settings) { _checkpoint = settings; }
+		void					set_functions(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions);
+		const std::string&			get_loss_function(void) const { return _loss_function; }
+		const std::string&			get_layer_function(void) const { return _layer_function; }
+		const std::string&			get_output_function(void) const { return _output_function; }
+
+		const Vector<double>&			feed_forward(const Vector<double>& inputs);
 
-		Vector<double>				feed_forward(const Vector<double>& inputs,
+		const Vector<double>&			feed_forward(const Vector<double>& inputs,
 							const std::string& layer_functions, const std::string& output_functions);
 		void					back_propagation(std::vector<Matrix<double>>& dW,
 							std::vector<Matrix<double>>& dZ, const std::string& loss_functions,const std::string& layer_functions,const std::string& output_functions, const Vector<double>& y);
-		model_measures_type			train(const std::string& loss_functions, const std::string& layer_functions,
-							const std::string& output_functions, const std::pair<batch_type, batch_type>& inputs, const std::pair<batch_type, batch_type>& outputs, const size_t& epochs);
+		const Matrix<double>&			feed_forward_batch(const Matrix<double>& inputs,
+							const std::string& layer_functions, const std::string& output_functions);
+		void					back_propagation_batch(std::vector<Matrix<double>>& dW,
+							std::vector<Matrix<double>>& dZ, const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions, const Matrix<double>& y);
+		model_measures_type			train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+							const DatasetView& training, const DatasetView& validation, const size_t& batch, const size_t& epochs, const size_t& threads = 1);
+		model_measures_type			train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+							const DatasetView& datas, const std::vector<size_t>& training, const std::vector<size_t>& validation,
+							const size_t& batch, const size_t& epochs, const size_t& threads = 1);
+		model_measures_type			train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+							IDataSource& training, IDataSource& validation, const size_t& batch, const size_t& epochs, const size_t& threads = 1,
+							const size_t& chunk = 65536, const size_t& prefetch = 2);
 		void					update_weights_bias(const std::vector<Matrix<double>>& dW,
 							const std::vector<Matrix<double>>& dZ, const size_t& batch);
-		static batch_type			batching(const std::vector<std::vector<double>>& list, const size_t& batch);
 		void					randomize_weights(const size_t& layer, const double& min, const double& max);
 		void					randomize_weights(const double& min, const double& max);
 		void					randomize_bias(const size_t& layer, const double& min, const double& max);
@@ -85,11 +150,16 @@ class	ARNetwork
 
 inline std::mt19937&	global_urng(void)
 {
-	std::random_device rd;
-	static std::mt19937 gen(rd());
+	static std::mt19937 gen(std::random_device{}());
 	return gen;
 }
 
+// make every following random draw (weights, bias, shuffling) reproducible
+inline void	seed_urng(const std::mt19937::result_type& seed)
+{
+	global_urng().seed(seed);
+}
+
 inline double	random_double(const double& min, const double& max)
 {
 	std::uniform_real_distribution<double> dist(min, max);
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Number of heap allocations made by the process so far
+ * 
+ * Debug builds (make debug, which defines ARN_COUNT_ALLOCATIONS) replace
+ * the global operator new to count them, which lets the training loop
+ * check it doesn't allocate once warm. Always 0 otherwise.
+ */
+size_t	allocation_count(void);
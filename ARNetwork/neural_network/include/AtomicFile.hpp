@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * @brief File replaced all at once, once it is completely written
+ *
+ * Writes go through a buffer into `<file_name>.tmp`. commit() syncs it to
+ * the disk and renames it over file_name: a crash or an error leaves either
+ * the previous file or the new one, never a part of it. The temporary file
+ * is removed if the object is destroyed before commit().
+ */
+class	AtomicFile
+{
+	private:
+		std::string		_file_name;
+		std::string		_temporary;
+		int			_fd;
+		std::vector<char>	_buffer;
+		size_t			_size;
+
+		void			write_all(const char *data, const size_t& size);
+		void			flush(void);
+
+	public:
+					AtomicFile(const std::string& file_name);
+					~AtomicFile(void);
+					AtomicFile(const AtomicFile&) = delete;
+
+		AtomicFile&		operator=(const AtomicFile&) = delete;
+
+		void			write(const char *data, const size_t& size);
+		void			put(const char& c) { if (_size == _buffer.size()) flush(); _buffer[_size++] = c; }
+		void			commit(void);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Dataset.hpp"
+#include "DataSource.hpp"
+#include "MappedFile.hpp"
+#include <string>
+
+/*
+ * Layout of a binary dataset file, in the byte order of the machine:
+ *
+ *   header    BinaryHeader, 64 bytes
+ *   features  rows * nbr_features values, row-major
+ *   labels    rows * nbr_labels values, row-major
+ *
+ * Each block starts on a 64 bytes boundary and its values are float64 or
+ * float32, as said by value_size. A float64 file mapped in memory is used
+ * as it is, without copy nor parsing.
+ */
+
+#define BINARY_MAGIC "ARNDATA"
+#define BINARY_VERSION 1
+#define BINARY_ALIGNMENT 64
+
+// how the label of an example is stored
+enum class LabelEncoding : uint32_t
+{
+	Binary = 0,	// one label y, 1 for M and 0 for B
+	OneHot = 1	// two labels (1 - y, y)
+};
+
+struct	BinaryHeader
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	value_size;	// 8 for float64, 4 for float32
+	uint64_t	rows;
+	uint64_t	nbr_features;
+	uint64_t	nbr_labels;
+	uint32_t	label_encoding;
+	uint8_t		reserved[20];
+};
+
+static_assert(sizeof(BinaryHeader) == BINARY_ALIGNMENT, "the header fills the first block");
+
+void	write_binary(const std::string& file_name, const DatasetView& datas, const LabelEncoding& encoding, const size_t& value_size = 8);
+
+/**
+ * @brief Dataset read from a binary dataset file mapped in memory
+ *
+ * float64 files are used in place, only the pages which are touched are
+ * read from the disk. float32 files are converted once when opened.
+ */
+class	BinaryDataset
+{
+	private:
+		MappedFile		_file;
+		BinaryHeader		_header;
+		Dataset			_converted;
+		DatasetView		_view;
+
+	public:
+					BinaryDataset(const std::string& file_name);
+					~BinaryDataset(void) {}
+					BinaryDataset(const BinaryDataset&) = delete;
+
+		BinaryDataset&		operator=(const BinaryDataset&) = delete;
+
+		const DatasetView&	view(void) const { return _view; }
+		LabelEncoding		label_encoding(void) const { return static_cast<LabelEncoding>(_header.label_encoding); }
+		size_t			value_size(void) const { return _header.value_size; }
+};
+
+/**
+ * @brief Binary dataset file read a chunk at a time
+ *
+ * The file is mapped, rows are copied into the chunk and converted if they
+ * are float32.
+ */
+class	BinarySource : public IDataSource
+{
+	private:
+		MappedFile		_file;
+		BinaryHeader		_header;
+		size_t			_row;
+
+	public:
+					BinarySource(const std::string& file_name);
+					~BinarySource(void) {}
+
+		size_t			nbr_features(void) const override { return _header.nbr_features; }
+		size_t			nbr_labels(void) const override { return _header.nbr_labels; }
+		void			rewind(void) override { _row = 0; }
+		size_t			read(Dataset& chunk, const size_t& rows) override;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <random>
+#include <map>
+
+class	ARNetwork;
+
+// loss and r2 of each epoch, on the training examples then on the validation ones
+using TrainingHistory = std::pair<std::map<size_t, std::pair<double, double>>, std::map<size_t, std::pair<double, double>>>;
+
+// when a training saves a checkpoint, never if file_name is empty
+struct	CheckpointSettings
+{
+	std::string	file_name;
+	size_t		epochs;		// every this many epochs, 0 for never
+	double		seconds;	// or once this many seconds passed since the last one, 0 for never
+};
+
+/**
+ * @brief What a training needs to go on from where it stopped
+ *
+ * Plain SGD keeps no moments: the optimizer state is the learning rate.
+ * With the generator the order of the examples is drawn from, a training
+ * resumed from a state runs the same epochs as if it never stopped.
+ */
+struct	TrainingState
+{
+	std::vector<Matrix<double>>	weights;
+	std::vector<Vector<double>>	bias;
+	double				learning_rate;
+	std::string			loss_function;
+	std::string			layer_function;
+	std::string			output_function;
+	size_t				epoch;		// epochs done
+	std::mt19937			urng;
+	TrainingHistory			history;
+};
+
+void	write_checkpoint(const std::string& file_name, const TrainingState& state);
+
+/**
+ * @brief Saves the state of a training on a background thread
+ *
+ * save() copies the network into one of two states allocated once, then
+ * returns: the other one may be on its way to the disk. When a snapshot is
+ * taken while the previous one still waits to be written, the newer one
+ * replaces it. The training never waits for the disk.
+ */
+class	Checkpointer
+{
+	private:
+		using clock = std::chrono::steady_clock;
+
+		CheckpointSettings		_settings;
+		TrainingState			_states[2];
+		int				_pending;	// state waiting to be written, -1 if none
+		int				_writing;	// state being written, -1 if none
+		bool				_stop;
+		std::exception_ptr		_error;
+		clock::time_point		_last;
+		std::mutex			_mutex;
+		std::condition_variable		_changed;
+		std::thread			_thread;
+
+		void				work(void);
+
+	public:
+						Checkpointer(const CheckpointSettings& settings, const ARNetwork& network);
+						~Checkpointer(void);
+						Checkpointer(const Checkpointer&) = delete;
+
+		Checkpointer&			operator=(const Checkpointer&) = delete;
+
+		bool				due(const size_t& epoch) const;
+		void				save(const ARNetwork& network);
+		void				finish(void);
+};
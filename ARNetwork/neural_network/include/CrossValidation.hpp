@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ARNetwork.hpp"
+#include "Split.hpp"
+
+struct	FoldResult
+{
+	std::pair<double, double>	training;	// loss and r2 of the last epoch
+	std::pair<double, double>	validation;
+};
+
+struct	CrossValidationReport
+{
+	std::vector<FoldResult>		folds;
+	// over the validation measures of the folds, the variances are unbiased
+	double				loss_mean;
+	double				loss_variance;
+	double				r2_mean;
+	double				r2_variance;
+};
+
+CrossValidationReport	cross_validate(const ARNetwork& model, const DatasetView& datas, const std::vector<SplitIndices>& folds,
+	const size_t& batch, const size_t& epochs, const size_t& threads);
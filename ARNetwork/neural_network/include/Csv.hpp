@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Dataset.hpp"
+#include "DataSource.hpp"
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Layout of the lines of a CSV file holding one example per line
+ *
+ * A line is `skip` ignored columns, the label (M, B, 1 or 0, M being 1),
+ * then `nbr_features` numbers, separated by commas. The ignored columns,
+ * such as an id, must be numbers too. Empty lines are ignored.
+ * Lines of inputs to predict may have no label column, their label is 0.
+ */
+struct	CsvFormat
+{
+	size_t		skip;
+	size_t		nbr_features;
+	bool		one_hot;	// label y stored as the two labels (1 - y, y) instead of y
+	size_t		threads;	// 0 uses every core
+	bool		labeled = true;
+};
+
+Dataset	read_csv(const std::string& file_name, const CsvFormat& format);
+
+/**
+ * @brief CSV file read sequentially, a chunk of examples at a time
+ *
+ * Only a read buffer of a few lines is kept in memory, whatever the size of
+ * the file. Lines are parsed and checked like read_csv does.
+ */
+class	CsvSource : public IDataSource
+{
+	private:
+		std::string		_file_name;
+		CsvFormat		_format;
+		std::ifstream		_file;
+		std::vector<char>	_buffer;
+		size_t			_begin;
+		size_t			_end;
+		size_t			_line;
+
+		bool			fill(void);
+
+	public:
+					CsvSource(const std::string& file_name, const CsvFormat& format);
+					~CsvSource(void) {}
+
+		size_t			nbr_features(void) const override { return _format.nbr_features; }
+		size_t			nbr_labels(void) const override { return _format.one_hot ? 2 : 1; }
+		void			rewind(void) override;
+		size_t			read(Dataset& chunk, const size_t& rows) override;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Dataset.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+/**
+ * @brief Examples read in order, a chunk at a time, from something too big to load
+ */
+class	IDataSource
+{
+	public:
+		virtual			~IDataSource(void) {}
+		virtual size_t		nbr_features(void) const = 0;
+		virtual size_t		nbr_labels(void) const = 0;
+		// go back to the first example
+		virtual void		rewind(void) = 0;
+		// replace the content of chunk by the next examples, at most rows of them; 0 once every example was read
+		virtual size_t		read(Dataset& chunk, const size_t& rows) = 0;
+};
+
+/**
+ * @brief Reads an IDataSource ahead of its consumer on a background thread
+ *
+ * The reader owns prefetch + 1 chunks of chunk_rows examples, allocated once:
+ * while the consumer works on one, up to prefetch others are being filled.
+ * start() begins a pass over a source, next() hands out its chunks in order
+ * and gives the previous one back to the reader.
+ */
+class	ChunkReader
+{
+	private:
+		std::vector<Dataset>		_slots;
+		size_t				_chunk_rows;
+		size_t				_head;
+		size_t				_count;
+		bool				_holding;
+		bool				_ended;
+		bool				_reading;
+		bool				_stop;
+		IDataSource			*_source;
+		std::exception_ptr		_error;
+		std::mutex			_mutex;
+		std::condition_variable		_changed;
+		std::thread			_thread;
+
+		void				work(void);
+
+	public:
+						ChunkReader(const size_t& chunk_rows, const size_t& prefetch);
+						~ChunkReader(void);
+						ChunkReader(const ChunkReader&) = delete;
+
+		ChunkReader&			operator=(const ChunkReader&) = delete;
+
+		void				start(IDataSource& source);
+		const Dataset			*next(void);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <vector>
+#include <random>
+#include <cstdint>
+
+class	Dataset;
+
+/**
+ * @brief Read-only window over consecutive examples of a Dataset
+ *
+ * Holds pointers into the dataset, nothing is copied. Only valid while the
+ * dataset, or the memory the pointers come from, is alive and doesn't grow.
+ */
+class	DatasetView
+{
+	private:
+		const double		*_features;
+		const double		*_labels;
+		size_t			_size;
+		size_t			_nbr_features;
+		size_t			_nbr_labels;
+
+	public:
+					DatasetView(const double *features, const double *labels, const size_t& size, const size_t& nbr_features, const size_t& nbr_labels)
+					: _features(features), _labels(labels), _size(size), _nbr_features(nbr_features), _nbr_labels(nbr_labels) {}
+					DatasetView(const Dataset& datas);
+
+		const size_t&		size(void) const { return _size; }
+		bool			empty(void) const { return _size == 0; }
+		const size_t&		nbr_features(void) const { return _nbr_features; }
+		const size_t&		nbr_labels(void) const { return _nbr_labels; }
+		const double		*features(const size_t& row = 0) const { return _features + row * _nbr_features; }
+		const double		*labels(const size_t& row = 0) const { return _labels + row * _nbr_labels; }
+		size_t			nbr_batches(const size_t& batch) const { return batch ? (_size + batch - 1) / batch : 0; }
+};
+
+/**
+ * @brief Examples of a data set stored in two contiguous row-major buffers
+ *
+ * Row i of the features and row i of the labels are one example. Batches
+ * are handed out as DatasetView, so splitting into batches copies nothing.
+ */
+class	Dataset
+{
+	private:
+		typedef std::vector<double, AlignedAllocator<double>>	storage;
+
+		storage			_features;
+		storage			_labels;
+		size_t			_nbr_features;
+		size_t			_nbr_labels;
+
+	public:
+					Dataset(void) : _nbr_features(0), _nbr_labels(0) {}
+					Dataset(const size_t& nbr_features, const size_t& nbr_labels);
+					Dataset(const std::vector<std::vector<double>>& features, const std::vector<std::vector<double>>& labels);
+					~Dataset(void) {}
+
+		size_t			size(void) const { return _nbr_features ? _features.size() / _nbr_features : 0; }
+		bool			empty(void) const { return size() == 0; }
+		const size_t&		nbr_features(void) const { return _nbr_features; }
+		const size_t&		nbr_labels(void) const { return _nbr_labels; }
+		const double		*features(const size_t& row = 0) const { return _features.data() + row * _nbr_features; }
+		const double		*labels(const size_t& row = 0) const { return _labels.data() + row * _nbr_labels; }
+		double			*features(const size_t& row = 0) { return _features.data() + row * _nbr_features; }
+		double			*labels(const size_t& row = 0) { return _labels.data() + row * _nbr_labels; }
+
+		void			reserve(const size_t& rows);
+		void			resize(const size_t& rows);
+		void			push_back(const double *features, const double *labels);
+		void			push_back(const std::vector<double>& features, const std::vector<double>& labels);
+
+		DatasetView		view(const size_t& offset, const size_t& count) const;
+		DatasetView		batch(const size_t& index, const size_t& batch) const;
+		size_t			nbr_batches(const size_t& batch) const;
+};
+
+// reproducible permutation of @param order drawn from @param urng
+void	shuffle_order(std::vector<size_t>& order, std::mt19937& urng);
@@ -8,6 +8,23 @@
 #include <limits>
 #include <memory>
 #include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include "Kernels.hpp"
+
+enum class	Activation
+{
+	ReLU,
+	Sigmoid,
+	TanH,
+	LeakyReLU,
+	Identity,
+	SoftMax
+};
+
+enum class	Loss
+{
+	MSE,
+	BCE
+};
 
 class	IActivation
 {
@@ -31,7 +48,7 @@ class	Sigmoid : public IActivation
 {
 	std::string	name(void) const override { return "sigmoid"; }
 	double		activate_scalar(const double& x) const override { return 1 / (1 + exp(-x)); }
-	double		derive_scalar(const double& x) const override { return activate_scalar(x) * (1 - activate_scalar(x)); }
+	double		derive_scalar(const double& x) const override { double s = activate_scalar(x); return s * (1 - s); }
 };
 
 class	TanH : public IActivation
@@ -95,4 +112,32 @@ class	LossFactory
 {
 	public:
 		static std::unique_ptr<ILoss>	create(const std::string& function);
-};
\ No newline at end of file
+};
+
+/*
+ * Activations and losses resolved once into an enum and applied on whole
+ * buffers: no allocation, no virtual call per element and no exception on
+ * the hot path.
+ *
+ * Buffers are described like a Matrix: `lines` x `columns` values, line i
+ * starting at i * stride. Each column is one example, so softmax and the
+ * losses work column by column; a Vector is lines = n, columns = 1, stride = 1.
+ *
+ * derive_output takes the activation output instead of z: it is how the
+ * backward pass gets the derivatives without running the activation again.
+ */
+
+Activation	activation_from_name(const std::string& function);
+Loss		loss_from_name(const std::string& function);
+
+void		activate(const Activation& function, const double *z, double *a, const size_t& lines, const size_t& columns, const size_t& stride);
+void		derive(const Activation& function, const double *z, double *d, const size_t& lines, const size_t& columns, const size_t& stride);
+void		derive_output(const Activation& function, const double *a, double *d, const size_t& lines, const size_t& columns, const size_t& stride);
+double		loss(const Loss& function, const double *a, const double *y, const size_t& lines, const size_t& columns, const size_t& stride);
+void		derive_loss(const Loss& function, const double *a, const double *y, double *gradients, const size_t& lines, const size_t& columns, const size_t& stride);
+
+void		activate(const Activation& function, const Matrix<double>& z, Matrix<double>& a);
+void		derive(const Activation& function, const Matrix<double>& z, Matrix<double>& d);
+void		derive_output(const Activation& function, const Matrix<double>& a, Matrix<double>& d);
+double		loss(const Loss& function, const Matrix<double>& a, const Matrix<double>& y);
+void		derive_loss(const Loss& function, const Matrix<double>& a, const Matrix<double>& y, Matrix<double>& gradients);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <vector>
+#include <string>
+#include <ostream>
+#include <algorithm>
+
+/**
+ * @brief Counts of values in power of two buckets: 0, 1, 2-3, 4-7, 8-15...
+ *
+ * Not synchronized, the owner records under its own lock.
+ */
+class	Histogram
+{
+	private:
+		std::vector<size_t>		_buckets;
+		size_t				_count;
+		size_t				_sum;
+		size_t				_max;
+
+	public:
+						Histogram(void) : _buckets(1), _count(0), _sum(0), _max(0) {}
+						~Histogram(void) {}
+
+		void				record(const size_t& value);
+		const size_t&			count(void) const { return _count; }
+		double				mean(void) const { return _count ? static_cast<double>(_sum) / static_cast<double>(_count) : 0; }
+		const size_t&			max(void) const { return _max; }
+		void				display(std::ostream& out, const std::string& name) const;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "ARNetwork.hpp"
+#include "ModelFile.hpp"
+#include <memory>
+
+// number of examples a scratch holds when predict has to size it
+#define INFERENCE_BATCH 256
+
+class	InferenceModel;
+
+/**
+ * @brief Buffers of one thread running examples through an InferenceModel
+ *
+ * Owned by the caller, one per thread: the model itself is never written,
+ * so any number of threads can share it as long as each has its own
+ * scratch. Sized once, then reused without allocating.
+ */
+class	InferenceScratch
+{
+	private:
+		friend class			InferenceModel;
+
+		std::vector<Matrix<double>>	_a;
+		Matrix<double>			_z;
+		size_t				_capacity;
+
+	public:
+						InferenceScratch(void) : _capacity(0) {}
+						InferenceScratch(const InferenceModel& model, const size_t& batch);
+						~InferenceScratch(void) {}
+
+		void				reserve(const InferenceModel& model, const size_t& batch);
+		const size_t&			capacity(void) const { return _capacity; }
+};
+
+// weights of a layer, row-major with lines of stride values, and its bias
+struct	InferenceLayer
+{
+	const double	*weights;
+	size_t		lines;
+	size_t		columns;
+	size_t		stride;
+	const double	*bias;
+};
+
+/**
+ * @brief Read-only weights and functions of an ARNetwork
+ *
+ * Every method is const and keeps no state between calls: one model serves
+ * concurrent predictions without locks. Examples are run in batches of the
+ * capacity of the scratch, one GEMM per layer.
+ *
+ * The weights are either a copy of those of a network or the pages of a
+ * mapped binary model file, shared with every process mapping it. Copies of
+ * a model share its weights.
+ */
+class	InferenceModel
+{
+	private:
+		std::shared_ptr<const void>	_storage;	// what the layers point to
+		std::vector<InferenceLayer>	_layers;
+		std::vector<size_t>		_topology;
+		Activation			_layer_activation;
+		Activation			_output_activation;
+
+		void				forward(InferenceScratch& scratch) const;
+
+	public:
+						InferenceModel(const ARNetwork& network);
+						InferenceModel(const std::shared_ptr<const ModelFile>& model);
+						InferenceModel(const std::shared_ptr<const ModelFile>& model, const std::string& layer_function, const std::string& output_function);
+						~InferenceModel(void) {}
+
+		const std::vector<size_t>&	topology(void) const { return _topology; }
+		size_t				size_inputs(void) const { return _topology.front(); }
+		size_t				size_outputs(void) const { return _topology.back(); }
+
+		void				predict(const double *inputs, const size_t& rows, double *outputs, InferenceScratch& scratch) const;
+		Vector<double>			predict(const Vector<double>& inputs, InferenceScratch& scratch) const;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "InferenceModel.hpp"
+#include "Histogram.hpp"
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/*
+ * Protocol, one JSON object per line both ways:
+ *
+ *   request   {"id": <any>, "inputs": [<size_inputs() numbers>]}
+ *   answer    {"id": <same>, "outputs": [<size_outputs() numbers>]}
+ *   or        {"id": <same>, "error": "<message>"}
+ *
+ * Answers of one connection can come in another order than the requests,
+ * the id tells which request they answer.
+ */
+
+/**
+ * @brief One client of the server: where its requests come from and its answers go
+ *
+ * Answers are written whole, one at a time; a write blocked by a slow
+ * client doesn't keep its requests from being read. The file descriptors are closed
+ * with the connection when it owns them.
+ */
+class	Connection
+{
+	private:
+		int				_input;
+		int				_output;
+		bool				_owned;
+		size_t				_pending;
+		std::mutex			_write;
+		std::mutex			_mutex;
+		std::condition_variable		_answered;
+
+	public:
+						Connection(const int& input, const int& output, const bool& owned)
+						: _input(input), _output(output), _owned(owned), _pending(0) {}
+						~Connection(void);
+						Connection(const Connection&) = delete;
+
+		Connection&			operator=(const Connection&) = delete;
+
+		const int&			input(void) const { return _input; }
+		void				submitted(void);
+		void				write(const std::string& line);
+		void				answer(const std::string& line);
+		void				wait_answers(void);
+};
+
+struct	Request
+{
+	std::shared_ptr<Connection>			connection;
+	nlohmann::json					id;
+	std::vector<double>				inputs;
+	std::chrono::steady_clock::time_point		arrival;
+};
+
+/**
+ * @brief How the workers group requests into one forward pass
+ *
+ * A worker takes up to max_batch queued requests. With fewer queued, it
+ * waits for more until the oldest one has waited max_wait: 0 runs what is
+ * there right away, longer waits trade latency for bigger batches.
+ */
+struct	BatchingSettings
+{
+	size_t				max_batch;
+	std::chrono::microseconds	max_wait;
+};
+
+/**
+ * @brief Resident scoring service answering JSON-lines requests
+ *
+ * The model is loaded once. Connections are read by their own thread, which
+ * parses the requests and queues them; a fixed set of workers, each with
+ * its own InferenceScratch on the shared read-only model, runs them in
+ * micro-batches, one GEMM per layer for the whole batch, and scatters the
+ * answers back to their connections.
+ */
+class	InferenceServer
+{
+	private:
+		const InferenceModel&		_model;
+		BatchingSettings		_batching;
+		std::deque<Request>		_queue;
+		std::mutex			_mutex;
+		std::condition_variable		_queued;
+		bool				_closed;
+		Histogram			_queue_depths;
+		Histogram			_batch_sizes;
+		std::vector<std::thread>	_workers;
+
+		void				work(void);
+		void				read_request(const std::shared_ptr<Connection>& connection, const char *begin, const char *end);
+		void				read_requests(const std::shared_ptr<Connection>& connection);
+
+	public:
+						InferenceServer(const InferenceModel& model, const size_t& threads, const BatchingSettings& batching = {1, std::chrono::microseconds(0)});
+						~InferenceServer(void);
+						InferenceServer(const InferenceServer&) = delete;
+
+		InferenceServer&		operator=(const InferenceServer&) = delete;
+
+		void				serve(const int& input, const int& output);
+		void				listen(const std::string& socket_path);
+		void				statistics(std::ostream& out);
+};
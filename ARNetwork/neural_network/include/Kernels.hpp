@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Activation kernels working on `n` contiguous doubles.
+ *
+ * On CPUs with AVX2 and FMA four values are computed at once and exp is
+ * evaluated with a polynomial instead of calling std::exp; elsewhere the
+ * kernels fall back to the plain std:: formulas, which are the reference.
+ * `in` and `out` may be the same buffer.
+ *
+ * Accuracy of the AVX2 kernels against the reference, checked by
+ * checks/kernels.cpp (make check) on the tails, +-0, +-inf and NaN too:
+ *	exp		<= 1 ulp, 0 and inf where std::exp gives them
+ *	sigmoid		<= 4 ulp
+ *	tanh		<= 4 ulp
+ *	relu, leakyrelu	exact, NaN goes through
+ * Subnormal results are rounded twice, which may cost them 1 more ulp.
+ */
+
+void		exp_kernel(const double *x, double *y, const size_t& n);
+void		sigmoid_kernel(const double *z, double *a, const size_t& n);
+void		tanh_kernel(const double *z, double *a, const size_t& n);
+void		relu_kernel(const double *z, double *a, const size_t& n);
+void		leaky_relu_kernel(const double *z, double *a, const size_t& n);
+void		identity_kernel(const double *z, double *a, const size_t& n);
+
+/*
+ * Derivatives computed from the activation output `a` instead of z, so a
+ * backward pass reuses what the forward pass produced and never evaluates
+ * exp again
+ */
+void		sigmoid_derive_output_kernel(const double *a, double *d, const size_t& n);
+void		tanh_derive_output_kernel(const double *a, double *d, const size_t& n);
+void		relu_derive_output_kernel(const double *a, double *d, const size_t& n);
+void		leaky_relu_derive_output_kernel(const double *a, double *d, const size_t& n);
+void		identity_derive_output_kernel(const double *a, double *d, const size_t& n);
+
+// the reference kernels, used on CPUs without AVX2
+void		exp_scalar(const double *x, double *y, const size_t& n);
+void		sigmoid_scalar(const double *z, double *a, const size_t& n);
+void		tanh_scalar(const double *z, double *a, const size_t& n);
+void		relu_scalar(const double *z, double *a, const size_t& n);
+void		leaky_relu_scalar(const double *z, double *a, const size_t& n);
+
+// name of the kernels picked at runtime for this CPU ("avx2" or "scalar")
+const char	*activation_kernel_name(void);
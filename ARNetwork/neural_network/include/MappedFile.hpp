@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * The pages are loaded by the kernel on first access, opening a file costs
+ * the same whatever its size. The mapping lives as long as the object.
+ */
+class	MappedFile
+{
+	private:
+		const char		*_data;
+		size_t			_size;
+
+	public:
+					MappedFile(const std::string& file_name);
+					~MappedFile(void);
+					MappedFile(const MappedFile&) = delete;
+
+		MappedFile&		operator=(const MappedFile&) = delete;
+
+		const char		*data(void) const { return _data; }
+		const size_t&		size(void) const { return _size; }
+};
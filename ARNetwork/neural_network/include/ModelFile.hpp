@@ -0,0 +1,88 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+ * Layout of a binary model file, in the byte order of the machine:
+ *
+ *   header    ModelHeader, 128 bytes
+ *   layers    one ModelLayer per layer of weights
+ *   blocks    for each layer, its weights then its bias
+ *
+ * The weights of a layer are `lines` rows of `stride` float64, row-major,
+ * the columns after `columns` being 0: the layout of a Matrix, used in
+ * place once mapped. Each block starts on a 64 bytes boundary and the file
+ * ends on one. The checksum covers everything after the header.
+ */
+
+#define MODEL_MAGIC "ARNMODL"
+#define MODEL_VERSION 1
+#define MODEL_ALIGNMENT 64
+#define MODEL_NAME_SIZE 16
+
+struct	ModelHeader
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	nbr_layers;
+	uint64_t	payload_size;	// bytes after the header
+	uint64_t	checksum;	// FNV-1a of the payload, 64 bits at a time
+	double		learning_rate;
+	char		loss[MODEL_NAME_SIZE];
+	char		hidden_activation[MODEL_NAME_SIZE];
+	char		output_activation[MODEL_NAME_SIZE];
+	uint8_t		reserved[40];
+};
+
+// a layer of weights, offsets from the beginning of the file
+struct	ModelLayer
+{
+	uint64_t	lines;
+	uint64_t	columns;
+	uint64_t	stride;
+	uint64_t	weights;
+	uint64_t	bias;
+};
+
+static_assert(sizeof(ModelHeader) == 2 * MODEL_ALIGNMENT, "the header fills the first two blocks");
+
+class	ARNetwork;
+
+void	write_model(const std::string& file_name, const ARNetwork& network);
+bool	is_model_file(const std::string& file_name);
+
+/**
+ * @brief Binary model file mapped in memory
+ *
+ * Opening only checks the header and the layer table, the weights are read
+ * from the pages of the file when they are used: processes mapping the same
+ * model share them. The checksum needs every page, it is only checked if
+ * asked to.
+ */
+class	ModelFile
+{
+	private:
+		MappedFile			_file;
+		ModelHeader			_header;
+		std::vector<ModelLayer>		_layers;
+
+	public:
+						ModelFile(const std::string& file_name, const bool& verify = true);
+						~ModelFile(void) {}
+						ModelFile(const ModelFile&) = delete;
+
+		ModelFile&			operator=(const ModelFile&) = delete;
+
+		size_t				nbr_layers(void) const { return _layers.size(); }
+		const ModelLayer&		layer(const size_t& index) const { return _layers[index]; }
+		const double			*weights(const size_t& index) const { return reinterpret_cast<const double *>(_file.data() + _layers[index].weights); }
+		const double			*bias(const size_t& index) const { return reinterpret_cast<const double *>(_file.data() + _layers[index].bias); }
+		std::vector<size_t>		topology(void) const;
+		double				learning_rate(void) const { return _header.learning_rate; }
+		std::string			loss_function(void) const { return _header.loss; }
+		std::string			layer_function(void) const { return _header.hidden_activation; }
+		std::string			output_function(void) const { return _header.output_activation; }
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Dataset.hpp"
+#include <random>
+#include <vector>
+#include <string>
+
+/*
+ * Splits are computed on row indices: one Fisher–Yates permutation, then
+ * the indices are dealt to the sets, O(n) whatever the size of the data.
+ * Stratified splits permute the M and B examples separately so each set
+ * keeps the proportion of M of the whole data set.
+ */
+
+struct	SplitIndices
+{
+	std::vector<size_t>	training;
+	std::vector<size_t>	validation;
+};
+
+SplitIndices			split_indices(const DatasetView& datas, const double& training_ratio, const bool& stratify, std::mt19937& urng);
+std::vector<SplitIndices>	kfold_indices(const DatasetView& datas, const size_t& folds, const bool& stratify, std::mt19937& urng);
+Dataset				select_rows(const DatasetView& datas, const std::vector<size_t>& rows);
+void				normalize_features(Dataset& datas);
+
+// arguments of the programs working on data.csv
+std::vector<size_t>		get_network(const std::string& arg);
+size_t				positive_integer(const std::string& flag, const char *arg, const bool& zero = false);
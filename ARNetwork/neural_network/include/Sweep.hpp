@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ARNetwork.hpp"
+#include "Split.hpp"
+#include "WorkStealingPool.hpp"
+
+struct	TrialConfig
+{
+	std::vector<size_t>	layers;		// every layer, inputs and outputs included
+	double			learning_rate;
+	size_t			batch;
+	std::string		layer_function;
+};
+
+struct	TrialResult
+{
+	TrialConfig		config;
+	size_t			epochs;		// epochs trained before the trial ended
+	double			loss;		// validation loss and r2 of the last epoch
+	double			r2;
+	bool			stopped;	// cancelled by successive halving
+};
+
+/**
+ * @brief Budget of a successive halving sweep
+ *
+ * Every trial trains min_epochs, then only the best 1 / eta of them go on
+ * training eta times as many epochs, and so on up to max_epochs.
+ */
+struct	SweepSettings
+{
+	size_t			min_epochs;
+	size_t			max_epochs;
+	size_t			eta;
+	size_t			threads;
+};
+
+std::vector<TrialConfig>	grid_configs(const std::vector<std::vector<size_t>>& layers, const std::vector<double>& learning_rates,
+	const std::vector<size_t>& batches, const std::vector<std::string>& layer_functions);
+std::vector<TrialConfig>	random_configs(const std::vector<std::vector<size_t>>& layers, const std::vector<double>& learning_rates,
+	const std::vector<size_t>& batches, const std::vector<std::string>& layer_functions, const size_t& count, std::mt19937& urng);
+std::vector<TrialResult>	sweep(const std::vector<TrialConfig>& configs, const DatasetView& datas, const SplitIndices& split, const SweepSettings& settings);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+
+/**
+ * @brief Fixed set of worker threads running indexed tasks
+ *
+ * run(count, task) calls task(i) for every i in [0, count) and returns once
+ * they are all done; the calling thread takes part in the work. Which
+ * thread runs which index is not fixed, so a task must only depend on its
+ * index for the results to be reproducible.
+ * Dispatching a job doesn't allocate, the pool can be used in a warm loop.
+ */
+class	ThreadPool
+{
+	private:
+		typedef void				(*task_type)(void *, const size_t&);
+
+		std::vector<std::thread>		_workers;
+		std::mutex				_mutex;
+		std::condition_variable			_wake;
+		std::condition_variable			_done;
+		task_type				_task;
+		void					*_context;
+		size_t					_count;
+		std::atomic<size_t>			_next;
+		size_t					_running;
+		size_t					_generation;
+		bool					_stop;
+		std::exception_ptr			_error;
+
+		void					work(void);
+		void					execute(void);
+		void					dispatch(const task_type& task, void *context, const size_t& count);
+
+		template <typename F>
+		static void				call(void *context, const size_t& index) { (*static_cast<F *>(context))(index); }
+
+	public:
+							ThreadPool(const size_t& threads);
+							~ThreadPool(void);
+							ThreadPool(const ThreadPool&) = delete;
+
+		ThreadPool&				operator=(const ThreadPool&) = delete;
+
+		// number of threads working on a job, the caller included
+		size_t					size(void) const { return _workers.size() + 1; }
+
+		template <typename F>
+		void					run(const size_t& count, F& task);
+};
+
+template <typename F>
+void	ThreadPool::run(const size_t& count, F& task)
+{
+	if (_workers.empty() || count <= 1)
+	{
+		for (size_t i = 0 ; i < count ; i++)
+			task(i);
+		return ;
+	}
+	dispatch(call<F>, &task, count);
+}
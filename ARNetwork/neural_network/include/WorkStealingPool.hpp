@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+/**
+ * @brief Worker threads running indexed tasks of uneven cost
+ *
+ * Same contract as ThreadPool: run(count, task) calls task(i) for every i in
+ * [0, count), the caller taking part. Each thread starts with its own block
+ * of indices and takes them from the front; once it runs out it steals from
+ * the back of the other threads' blocks, so a thread stuck on long tasks
+ * hands its remaining work to idle ones.
+ * The threads are those of a ThreadPool, which runs one index per queue.
+ */
+class	WorkStealingPool
+{
+	private:
+		typedef void				(*task_type)(void *, const size_t&);
+
+		struct	Queue
+		{
+			std::mutex			mutex;
+			std::deque<size_t>		tasks;
+		};
+
+		ThreadPool				_pool;
+		std::vector<std::unique_ptr<Queue>>	_queues;
+		std::mutex				_mutex;
+		task_type				_task;
+		void					*_context;
+		std::atomic<size_t>			_steals;
+		std::exception_ptr			_error;
+
+		bool					take(const size_t& self, size_t& index);
+		void					execute(const size_t& self);
+		void					dispatch(const task_type& task, void *context, const size_t& count);
+
+		template <typename F>
+		static void				call(void *context, const size_t& index) { (*static_cast<F *>(context))(index); }
+
+	public:
+							WorkStealingPool(const size_t& threads);
+							WorkStealingPool(const WorkStealingPool&) = delete;
+
+		WorkStealingPool&			operator=(const WorkStealingPool&) = delete;
+
+		// number of threads working on a job, the caller included
+		size_t					size(void) const { return _queues.size(); }
+		// number of tasks run by another thread than the one they were given to
+		size_t					steals(void) const { return _steals; }
+
+		template <typename F>
+		void					run(const size_t& count, F& task) { dispatch(call<F>, &task, count); }
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../../linear_algebra/include/LinearAlgebra.hpp"
+#include <algorithm>
+
+/**
+ * @brief Every intermediate buffer needed to run a batch through an ARNetwork
+ * 
+ * Sized once from the topology and the biggest batch, then reused across
+ * batches and epochs: reshaping to a smaller batch keeps the allocations,
+ * so the training loop doesn't touch the heap once it is warm.
+ * Matrices hold one example per column.
+ */
+class	Workspace
+{
+	public:
+		std::vector<Matrix<double>>	_z;
+		std::vector<Matrix<double>>	_a;
+		std::vector<Matrix<double>>	_dW;
+		std::vector<Matrix<double>>	_dZ;
+		Matrix<double>			_y;
+		Matrix<double>			_delta;
+		Matrix<double>			_derivative;
+		Matrix<double>			_dA;
+		size_t				_capacity;
+
+					Workspace(void) : _capacity(0) {}
+					Workspace(const std::vector<size_t>& topology, const size_t& batch) : _capacity(0) { reserve(topology, batch); }
+					~Workspace(void) {}
+
+		void			reserve(const std::vector<size_t>& topology, const size_t& batch);
+		void			reset_gradients(void);
+		const size_t&		capacity(void) const { return _capacity; }
+};
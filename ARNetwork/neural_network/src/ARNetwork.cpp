@@ -27,7 +27,14 @@ ARNetwork::ARNetwork(const std::vector<size_t>& network)
 	_outputs = Vector<double>(outputs);
 	_z = std::vector<Vector<double>>(hidden_layers + 1);
 	_a = std::vector<Vector<double>>(hidden_layers + 1);
+	_steady_state_allocations = 0;
+	_epoch = 0;
+	_checkpoint = {"", 0, 0};
 	_learning_rate = 0.1;
+	_shuffle = true;
+	_urng = &global_urng();
+	_has_saved_urng = false;
+	set_functions("bce", "sigmoid", "softmax");
 	for (size_t i = 0 ; i < hidden_layers + 1 ; i++)
 	{
 		_weights[i] = Matrix<double>(network[i + 1], network[i]);
@@ -42,7 +49,10 @@ ARNetwork::ARNetwork(const std::vector<size_t>& network)
 	}
 }
 
-ARNetwork::ARNetwork(const ARNetwork& arn) : _inputs(arn._inputs), _outputs(arn._outputs), _weights(arn._weights), _z(arn._z), _a(arn._a), _bias(arn._bias), _learning_rate(arn._learning_rate) {}
+ARNetwork::ARNetwork(const ARNetwork& arn) : _inputs(arn._inputs), _outputs(arn._outputs), _weights(arn._weights), _z(arn._z), _a(arn._a), _bias(arn._bias),
+	_shuffle(arn._shuffle), _urng(arn._urng == &arn._saved_urng ? &_saved_urng : arn._urng),
+	_saved_urng(arn._saved_urng), _has_saved_urng(arn._has_saved_urng), _steady_state_allocations(0), _epoch(arn._epoch), _history(arn._history), _checkpoint({"", 0, 0}), _learning_rate(arn._learning_rate), _layer_function(arn._layer_function), _output_function(arn._output_function),
+	_loss_function(arn._loss_function), _layer_activation(arn._layer_activation), _output_activation(arn._output_activation), _loss_activation(arn._loss_activation) {}
 
 ARNetwork	ARNetwork::operator=(const ARNetwork& arn)
 {
@@ -55,9 +65,18 @@ ARNetwork	ARNetwork::operator=(const ARNetwork& arn)
 		_a = arn._a;
 		_bias = arn._bias;
 		_learning_rate = arn._learning_rate;
+		_shuffle = arn._shuffle;
+		_saved_urng = arn._saved_urng;
+		_has_saved_urng = arn._has_saved_urng;
+		_urng = arn._urng == &arn._saved_urng ? &_saved_urng : arn._urng;
+		_epoch = arn._epoch;
+		_history = arn._history;
 		_layer_function = arn._layer_function;
 		_output_function = arn._output_function;
 		_loss_function = arn._loss_function;
+		_layer_activation = arn._layer_activation;
+		_output_activation = arn._output_activation;
+		_loss_activation = arn._loss_activation;
 	}
 	return *this;
 }
@@ -80,6 +99,31 @@ void	ARNetwork::set_bias(const size_t& i, const size_t& j, const double& bias)
 	_bias[i][j] = bias;
 }
 
+/**
+ * @brief Choose the loss and activation functions used by the network
+ * 
+ * The names are resolved here once, so the passes never look them up again
+ * and never throw on them. Until it is called the network uses bce, sigmoid and softmax
+ * 
+ * @param loss_functions name of the loss function
+ * @param layer_functions name of the activation function for the hidden layers
+ * @param output_functions name of the activation function for the output layer
+ */
+void	ARNetwork::set_functions(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions)
+{
+	if (loss_functions == _loss_function && layer_functions == _layer_function && output_functions == _output_function)
+		return ;
+	Loss loss_activation = loss_from_name(loss_functions);
+	Activation layer_activation = activation_from_name(layer_functions);
+	Activation output_activation = activation_from_name(output_functions);
+	_loss_activation = loss_activation;
+	_layer_activation = layer_activation;
+	_output_activation = output_activation;
+	_loss_function = loss_functions;
+	_layer_function = layer_functions;
+	_output_function = output_functions;
+}
+
 /**
  * @brief Perform a forward pass through the neural network
  * 
@@ -87,43 +131,48 @@ void	ARNetwork::set_bias(const size_t& i, const size_t& j, const double& bias)
  * @param layer_functions name of the activation function for the hidden layers
  * @param output_functions name of the activation function for the output layer
  * 
- * @return vector which contains the outputs
+ * @return vector which contains the outputs, until the next pass
  */
-Vector<double>	ARNetwork::feed_forward(const Vector<double>& inputs, const std::string& layer_functions, const std::string& output_functions)
+const Vector<double>&	ARNetwork::feed_forward(const Vector<double>& inputs, const std::string& layer_functions, const std::string& output_functions)
 {
-	auto output_activation = ActivationFactory::create(output_functions);
-	auto layer_activation = ActivationFactory::create(layer_functions);
+	set_functions(_loss_function, layer_functions, output_functions);
+	return feed_forward(inputs);
+}
+
+/**
+ * @brief Perform a forward pass with the functions given to set_functions
+ * 
+ * @param inputs vector which contains the values to compute
+ * 
+ * @return vector which contains the outputs, until the next pass
+ */
+const Vector<double>&	ARNetwork::feed_forward(const Vector<double>& inputs)
+{
+	if (inputs.dimension() != size_inputs())
+		throw Error("Error: inputs must have " + std::to_string(size_inputs()) + " values");
 	set_inputs(inputs);
-	Matrix<double> neurals = _inputs;
 	_a[0] = _inputs;
 	for (size_t i = 0 ; i < nbr_hidden_layers() + 1 ; i++)
 	{
-		_z[i] = _weights[i] * neurals + Matrix<double>(_bias[i]);
-		neurals = _z[i];
-		try
-		{
-			if (i == nbr_hidden_layers())
-				neurals = output_activation->activate_vector(neurals);
-			else
-				neurals = layer_activation->activate_vector(neurals);
-		}
-		catch (...)
-		{
-			for (size_t j = 0 ; j < neurals.getNbrLines() ; j++)
-			{
-				if (i == nbr_hidden_layers())
-					neurals[j][0] = output_activation->activate_scalar(neurals[j][0]);
-				else
-					neurals[j][0] = layer_activation->activate_scalar(neurals[j][0]);
-			}
-		}
-		if (i != nbr_hidden_layers())
-			_a[i + 1] = neurals;
+		gemv(_weights[i], _a[i], _z[i]);
+		for (size_t j = 0 ; j < _z[i].dimension() ; j++)
+			_z[i][j] += _bias[i][j];
+		Vector<double>& neurals = i == nbr_hidden_layers() ? _outputs : _a[i + 1];
+		if (neurals.dimension() != _z[i].dimension())
+			neurals = Vector<double>(_z[i].dimension());
+		activate(i == nbr_hidden_layers() ? _output_activation : _layer_activation, _z[i].data(), neurals.data(), _z[i].dimension(), 1, 1);
 	}
-	_outputs = Vector<double>(neurals);
 	return _outputs;
 }
 
+// copy @param vector into @param matrix, as its only column
+static void	stage(const Vector<double>& vector, Matrix<double>& matrix)
+{
+	matrix.resize(vector.dimension(), 1);
+	for (size_t i = 0 ; i < vector.dimension() ; i++)
+		matrix(i, 0) = vector[i];
+}
+
 /**
  * @brief Perform backward pass through the neural network
  * 
@@ -135,177 +184,505 @@ Vector<double>	ARNetwork::feed_forward(const Vector<double>& inputs, const std::
  * @param layer_functions name of the activation function used to compute hidden layers' weights' gradient
  * @param output_functions name of the activation function used to compute the gradient of the outputs' z value
  * @param y vector which contains the value we want to reach with the neural network
+ *
+ * The example of the last feed_forward goes through the workspace of the
+ * batches as a batch of one, which replaces a batch staged by
+ * feed_forward_batch.
  */
 void	ARNetwork::back_propagation(std::vector<Matrix<double>>& dW, std::vector<Matrix<double>>& dZ, const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions, const Vector<double>& y)
 {
-	auto output_activation = ActivationFactory::create(output_functions);
-	auto layer_activation = ActivationFactory::create(layer_functions);
-	auto loss_activation = LossFactory::create(loss_functions);
-	Matrix<double> dA(loss_activation->derive(_outputs, y));
+	if (y.dimension() != size_outputs())
+		throw Error("Error: y must have " + std::to_string(size_outputs()) + " values");
+	set_functions(loss_functions, layer_functions, output_functions);
+	if (_workspace.capacity() == 0)
+		_workspace.reserve(topology(), 1);
+	for (size_t l = 0 ; l < nbr_hidden_layers() + 1 ; l++)
+		stage(_a[l], _workspace._a[l]);
+	stage(_outputs, _workspace._a.back());
+	stage(y, _workspace._y);
+	backward(_workspace, dW, dZ, _workspace._y);
+}
+
+std::vector<size_t>	ARNetwork::topology(void) const
+{
+	std::vector<size_t> layers;
+	layers.push_back(size_inputs());
+	for (const auto& weights : _weights)
+		layers.push_back(weights.getNbrLines());
+	return layers;
+}
+
+// run the batch staged in workspace._a[0] through every layer
+void	ARNetwork::forward(Workspace& workspace)
+{
+	size_t batch = workspace._a[0].getNbrColumns();
+	for (size_t i = 0 ; i < nbr_hidden_layers() + 1 ; i++)
+	{
+		Matrix<double>& z = workspace._z[i];
+		const Matrix<double>& a = workspace._a[i];
+		z.resize(_weights[i].getNbrLines(), batch);
+		gemm(false, false, z.getNbrLines(), batch, _weights[i].getNbrColumns(), 1.0, _weights[i].data(), _weights[i].getStride(),
+			a.data(), a.getStride(), 0.0, z.data(), z.getStride());
+		for (size_t j = 0 ; j < z.getNbrLines() ; j++)
+			for (size_t k = 0 ; k < batch ; k++)
+				z(j, k) += _bias[i][j];
+		activate(i == nbr_hidden_layers() ? _output_activation : _layer_activation, z, workspace._a[i + 1]);
+	}
+}
+
+// accumulate into dW and dZ the gradients of the batch which went through forward
+void	ARNetwork::backward(Workspace& workspace, std::vector<Matrix<double>>& dW, std::vector<Matrix<double>>& dZ, const Matrix<double>& y)
+{
+	size_t batch = y.getNbrColumns();
+	Matrix<double> *delta = &workspace._delta;
+	Matrix<double> *dA = &workspace._dA;
+	Matrix<double>& derivative = workspace._derivative;
+	derive_loss(_loss_activation, workspace._a.back(), y, *delta);
 	for (int l = nbr_hidden_layers() ; l >= 0 ; l--)
 	{
-		Matrix<double> tmp(_z[l].dimension(), 1);
-		try
-		{
-			if (l == (int)nbr_hidden_layers())
-				tmp = output_activation->derive_vector(tmp);
-			else
-				tmp = layer_activation->derive_vector(tmp);
-		}
-		catch (...)
+		const Matrix<double>& a = workspace._a[l];
+		derive_output(l == (int)nbr_hidden_layers() ? _output_activation : _layer_activation, workspace._a[l + 1], derivative);
+		for (size_t i = 0 ; i < delta->getNbrLines() ; i++)
+			for (size_t j = 0 ; j < batch ; j++)
+				(*delta)(i, j) *= derivative(i, j);
+		if (dW[l].empty())
+			dW[l].resize(_weights[l].getNbrLines(), _weights[l].getNbrColumns());
+		gemm(false, true, dW[l].getNbrLines(), dW[l].getNbrColumns(), batch, 1.0, delta->data(), delta->getStride(),
+			a.data(), a.getStride(), 1.0, dW[l].data(), dW[l].getStride());
+		if (dZ[l].empty())
+			dZ[l].resize(delta->getNbrLines(), 1);
+		for (size_t i = 0 ; i < delta->getNbrLines() ; i++)
+			for (size_t j = 0 ; j < batch ; j++)
+				dZ[l](i, 0) += (*delta)(i, j);
+		if (l > 0)
 		{
-			for (size_t i = 0 ; i < tmp.getNbrLines() ; i++)
-			{
-				if (l == (int)nbr_hidden_layers())
-					tmp[i][0] = output_activation->derive_scalar(tmp[i][0]);
-				else
-					tmp[i][0] = layer_activation->derive_scalar(tmp[i][0]);
-			}
+			dA->resize(_weights[l].getNbrColumns(), batch);
+			gemm(true, false, dA->getNbrLines(), batch, _weights[l].getNbrLines(), 1.0, _weights[l].data(), _weights[l].getStride(),
+				delta->data(), delta->getStride(), 0.0, dA->data(), dA->getStride());
+			std::swap(delta, dA);
 		}
-		Matrix<double> z = dA.hadamard(tmp);
-		Matrix<double> w = z * Matrix<double>(_a[l]).transpose();
-		dZ[l] = dZ[l] + z;
-		dW[l] = dW[l] + w;
-		dA = _weights[l].transpose() * z;
 	}
 }
 
+/**
+ * @brief Perform a forward pass for a whole batch at once
+ * 
+ * Every layer is computed as a single matrix product on the batch
+ * 
+ * @param inputs matrix which contains one example per column
+ * @param layer_functions name of the activation function for the hidden layers
+ * @param output_functions name of the activation function for the output layer
+ * 
+ * @return matrix which contains the outputs of each example in its column
+ */
+const Matrix<double>&	ARNetwork::feed_forward_batch(const Matrix<double>& inputs, const std::string& layer_functions, const std::string& output_functions)
+{
+	if (inputs.getNbrLines() != size_inputs())
+		throw Error("Error: examples must have " + std::to_string(size_inputs()) + " inputs");
+	set_functions(_loss_function, layer_functions, output_functions);
+	if (_workspace.capacity() < inputs.getNbrColumns())
+		_workspace.reserve(topology(), inputs.getNbrColumns());
+	_workspace._a[0] = inputs;
+	forward(_workspace);
+	return _workspace._a.back();
+}
+
+/**
+ * @brief Perform backward pass for the batch given to the last feed_forward_batch
+ * 
+ * dW is accumulated as one product dZ * transpose(A) per layer
+ * 
+ * @param dW vector of matrices which contains the sum of the weights' gradient
+ * @param dZ vector of matrices which contains the sum of the z value's gradient
+ * @param loss_functions name of the loss functions used to compute the gradient of the network's outputs' gradient
+ * @param layer_functions name of the activation function used to compute hidden layers' weights' gradient
+ * @param output_functions name of the activation function used to compute the gradient of the outputs' z value
+ * @param y matrix which contains the value we want to reach for each example in its column
+ */
+void	ARNetwork::back_propagation_batch(std::vector<Matrix<double>>& dW, std::vector<Matrix<double>>& dZ, const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions, const Matrix<double>& y)
+{
+	if (_workspace.capacity() == 0 || y.getNbrColumns() != _workspace._a[0].getNbrColumns())
+		throw Error("Error: y doesn't match the batch given to feed_forward_batch");
+	set_functions(loss_functions, layer_functions, output_functions);
+	backward(_workspace, dW, dZ, y);
+}
+
 void	ARNetwork::update_weights_bias(const std::vector<Matrix<double>>& dW, const std::vector<Matrix<double>>& dZ, const size_t& batch)
 {
+	double rate = _learning_rate / static_cast<double>(batch);
 	for (size_t layer = 0 ; layer < nbr_hidden_layers() + 1 ; layer++)
 	{
-		_weights[layer] = _weights[layer] - dW[layer] * _learning_rate * static_cast<double>(1.0 / static_cast<double>(batch));
-		_bias[layer] = Matrix<double>(_bias[layer]) - dZ[layer] * _learning_rate * static_cast<double>(1.0 / static_cast<double>(batch));
+		Matrix<double>& weights = _weights[layer];
+		for (size_t i = 0 ; i < weights.getNbrLines() ; i++)
+		{
+			for (size_t j = 0 ; j < weights.getNbrColumns() ; j++)
+				weights(i, j) -= rate * dW[layer](i, j);
+			_bias[layer][i] -= rate * dZ[layer](i, 0);
+		}
 	}
 }
 
-static void	valid_lists(const std::vector<std::vector<std::vector<double>>>& inputs, const std::vector<std::vector<std::vector<double>>>& outputs, const size_t& size_inputs, const size_t& size_outputs)
+/**
+ * @brief Copy @param count rows of @param width values into a matrix holding one row per column
+ * 
+ * The rows taken are order[first], order[first + 1]... or first, first + 1... without @param order
+ */
+static void	gather(const double *datas, const size_t& width, const size_t *order, const size_t& first, const size_t& count, Matrix<double>& matrix)
 {
-	if (inputs.size() != outputs.size())
-		throw Error("Error: the number of batch of inputs and outputs must be the same");
-	for (size_t i = 0 ; i < inputs.size() ; i++)
+	matrix.resize(width, count);
+	for (size_t k = 0 ; k < count ; k++)
 	{
-		if (inputs[i].size() != outputs[i].size())
-			throw Error("Error: batch of inputs and outputs have different size");
-		for (size_t j = 0 ; j < inputs[i].size() ; j++)
+		const double *row = datas + (order ? order[first + k] : first + k) * width;
+		for (size_t i = 0 ; i < width ; i++)
+			matrix(i, k) = row[i];
+	}
+}
+
+/**
+ * @brief Sum the gradients of every slice into the first workspace
+ * 
+ * Pairs are added as a binary tree, each level in parallel. The order of
+ * the additions only depends on the number of slices, so a given number of
+ * threads always gives the same bits.
+ */
+void	ARNetwork::reduce_gradients(ThreadPool& pool, const size_t& slices)
+{
+	for (size_t step = 1 ; step < slices ; step *= 2)
+	{
+		auto add = [&](const size_t& pair)
 		{
-			if (inputs[i][j].size() != size_inputs)
-				throw Error("Error: example " + j + std::string(" must have " + size_inputs + std::string(" inputs")));
-			if (outputs[i][j].size() != size_outputs)
-				throw Error("Error: example " + j + std::string(" must have " + size_inputs + std::string(" outputs")));
-		}
+			size_t into = pair * 2 * step;
+			if (into + step >= slices)
+				return ;
+			Workspace& to = replica(into);
+			const Workspace& from = replica(into + step);
+			for (size_t l = 0 ; l < to._dW.size() ; l++)
+			{
+				double *dW = to._dW[l].data();
+				const double *other = from._dW[l].data();
+				for (size_t i = 0 ; i < to._dW[l].getNbrLines() * to._dW[l].getStride() ; i++)
+					dW[i] += other[i];
+				for (size_t i = 0 ; i < to._dZ[l].getNbrLines() ; i++)
+					to._dZ[l](i, 0) += from._dZ[l](i, 0);
+			}
+		};
+		pool.run((slices + 2 * step - 1) / (2 * step), add);
 	}
 }
 
-void	ARNetwork::process(const batch_type& inputs, const batch_type& outputs, const double& sstot, std::map<size_t, std::pair<double, double>>& track_training, const size_t& epoch, const bool& back)
+/**
+ * @brief Run every batch through the network, and learn from it if @param back
+ * 
+ * The loss and the squared errors of the examples are added to @param loss_index and @param ssres.
+ * Batches are taken from the @param size rows listed in @param order (the
+ * first rows in place when it is null) and gathered straight into the workspaces. Each batch is cut in
+ * one slice of consecutive examples per thread of @param pool; every slice
+ * goes through its own workspace, then the losses are summed in slice order
+ * and the gradients tree-reduced before the update.
+ */
+void	ARNetwork::process(ThreadPool& pool, const DatasetView& datas, const size_t *order, const size_t& size, const size_t& batch, const bool& back, double& loss_index, double& ssres)
 {
-	double nbr_vectorial_inputs = 0;
-	for (const auto& batch : inputs)
-		nbr_vectorial_inputs += batch.size();
-	double ssres = 0;
-	double loss_index = 0;
-	auto loss_activation = LossFactory::create(_loss_function);
-	for (size_t j = 0 ; j < inputs.size() ; j++)
+	for (size_t offset = 0 ; offset < size ; offset += batch)
 	{
-		std::vector<Matrix<double>> dW(nbr_hidden_layers() + 1);
-		std::vector<Matrix<double>> dZ(nbr_hidden_layers() + 1);
-		for (size_t k = 0 ; k < inputs[j].size() ; k++)
+		size_t count = std::min(batch, size - offset);
+		size_t slices = std::min(pool.size(), count);
+		auto slice = [&](const size_t& t)
 		{
-			Vector<double> prediction = feed_forward(inputs[j][k], _layer_function, _output_function);
-			loss_index += loss_activation->activate(prediction, outputs[j][k]);
-			for (size_t l = 0 ; l < prediction.dimension() ; l++)
-				ssres += pow(prediction[l] - outputs[j][k][l], 2);
+			Workspace& workspace = replica(t);
+			size_t begin = t * count / slices;
+			size_t end = (t + 1) * count / slices;
+			gather(datas.features(), datas.nbr_features(), order, offset + begin, end - begin, workspace._a[0]);
+			gather(datas.labels(), datas.nbr_labels(), order, offset + begin, end - begin, workspace._y);
+			forward(workspace);
+			const Matrix<double>& prediction = workspace._a.back();
+			const Matrix<double>& y = workspace._y;
+			double squares = 0;
+			for (size_t l = 0 ; l < prediction.getNbrLines() ; l++)
+				for (size_t k = 0 ; k < prediction.getNbrColumns() ; k++)
+					squares += pow(prediction(l, k) - y(l, k), 2);
+			_partials[t] = {loss(_loss_activation, prediction, y), squares};
 			if (back)
-				back_propagation(dW, dZ, _loss_function, _layer_function, _output_function, outputs[j][k]);
+			{
+				workspace.reset_gradients();
+				backward(workspace, workspace._dW, workspace._dZ, y);
+			}
+		};
+		pool.run(slices, slice);
+		for (size_t t = 0 ; t < slices ; t++)
+		{
+			loss_index += _partials[t].first;
+			ssres += _partials[t].second;
 		}
 		if (back)
-			update_weights_bias(dW, dZ, inputs[j].size());
+		{
+			reduce_gradients(pool, slices);
+			update_weights_bias(_workspace._dW, _workspace._dZ, count);
+		}
 	}
-	double r2 = 1.0 - ssres / sstot;
-	track_training[epoch] = {loss_index / nbr_vectorial_inputs, r2};
 }
 
-static double	compute_sstot(const std::vector<std::vector<std::vector<double>>>& outputs)
+/**
+ * @brief Run every example of @param source through the network, a chunk at a time
+ * 
+ * The total sum of squares of the labels is accumulated with Welford's
+ * running mean, which stays as accurate as the two passes of compute_sstot
+ * even when the labels are far from 0 compared to their spread.
+ *
+ * @return the mean loss and the r2 of the pass
+ */
+std::pair<double, double>	ARNetwork::stream(ThreadPool& pool, ChunkReader& reader, IDataSource& source, const size_t& batch, const bool& back)
 {
-	double count_outputs = 0;
-	double nbr_scalar_outputs = 0;
-	for (const auto& batch : outputs)
+	double ssres = 0;
+	double loss_index = 0;
+	double mean = 0;
+	double sstot = 0;
+	size_t outputs = 0;
+	size_t examples = 0;
+	reader.start(source);
+	while (const Dataset *chunk = reader.next())
 	{
-		for (const auto& sample : batch)
+		const size_t *order = nullptr;
+		if (back && _shuffle)
 		{
-			for (const auto& coef : sample)
-			{
-				nbr_scalar_outputs += coef;
-				count_outputs++;
-			}
+			_order.resize(chunk->size());
+			std::iota(_order.begin(), _order.end(), 0);
+			shuffle_order(_order, *_urng);
+			order = _order.data();
 		}
+		process(pool, *chunk, order, chunk->size(), batch, back, loss_index, ssres);
+		for (size_t i = 0 ; i < chunk->size() * chunk->nbr_labels() ; i++)
+		{
+			double delta = chunk->labels()[i] - mean;
+			mean += delta / static_cast<double>(++outputs);
+			sstot += delta * (chunk->labels()[i] - mean);
+		}
+		examples += chunk->size();
 	}
-	double mean_output = nbr_scalar_outputs / count_outputs;
+	if (examples == 0)
+		throw Error("Error: train or validation inputs are missing");
+	return {loss_index / static_cast<double>(examples), 1.0 - ssres / sstot};
+}
+
+// size the workspaces of the threads for slices of a batch
+void	ARNetwork::reserve_training(const size_t& threads, const size_t& batch)
+{
+	size_t slice = (batch + threads - 1) / threads;
+	if (_workspace.capacity() < slice)
+		_workspace.reserve(topology(), slice);
+	_replicas.resize(threads - 1);
+	for (auto& workspace : _replicas)
+		if (workspace.capacity() < slice)
+			workspace.reserve(topology(), slice);
+	_partials.resize(threads);
+}
+
+// total sum of squares of the labels of the @param size rows of @param rows, the first ones when null
+static double	compute_sstot(const DatasetView& datas, const size_t *rows, const size_t& size)
+{
+	size_t count_outputs = size * datas.nbr_labels();
+	double nbr_scalar_outputs = 0;
+	for (size_t i = 0 ; i < size ; i++)
+		for (size_t j = 0 ; j < datas.nbr_labels() ; j++)
+			nbr_scalar_outputs += datas.labels(rows ? rows[i] : i)[j];
+	double mean_output = nbr_scalar_outputs / static_cast<double>(count_outputs);
 	double sstot = 0;
-	for (const auto& batch : outputs)
-		for (const auto& sample : batch)
-			for (const auto& coef : sample)
-				sstot += pow(coef - mean_output, 2);
+	for (size_t i = 0 ; i < size ; i++)
+		for (size_t j = 0 ; j < datas.nbr_labels() ; j++)
+			sstot += pow(datas.labels(rows ? rows[i] : i)[j] - mean_output, 2);
 	return sstot;
 }
 
+static void	valid_dataset(const DatasetView& datas, const size_t& size_inputs, const size_t& size_outputs)
+{
+	if (datas.empty())
+		throw Error("Error: train or validation inputs are missing");
+	if (datas.nbr_features() != size_inputs)
+		throw Error("Error: examples must have " + std::to_string(size_inputs) + " inputs");
+	if (datas.nbr_labels() != size_outputs)
+		throw Error("Error: examples must have " + std::to_string(size_outputs) + " outputs");
+}
+
+static void	valid_rows(const DatasetView& datas, const std::vector<size_t>& rows)
+{
+	if (rows.empty())
+		throw Error("Error: train or validation inputs are missing");
+	for (const size_t& row : rows)
+		if (row >= datas.size())
+			throw Error("Error: index out of range");
+}
+
+// the checkpointer of a training, null if set_checkpoint wasn't given a file
+std::unique_ptr<Checkpointer>	ARNetwork::start_checkpoints(void) const
+{
+	if (_checkpoint.file_name.empty())
+		return nullptr;
+	return std::make_unique<Checkpointer>(_checkpoint, *this);
+}
+
+// count an epoch done, and save a checkpoint if one is due
+void	ARNetwork::end_epoch(Checkpointer *checkpointer)
+{
+	_epoch++;
+	if (checkpointer && checkpointer->due(_epoch))
+		checkpointer->save(*this);
+}
+
+/**
+ * @brief Run the epochs of a training on @param training_size examples of
+ * @param training and @param validation_size of @param validation, taken
+ * in the order of the rows given, or the first ones when null
+ */
+ARNetwork::model_measures_type	ARNetwork::fit(ThreadPool& pool, const DatasetView& training, const size_t *training_rows, const size_t& training_size,
+	const DatasetView& validation, const size_t *validation_rows, const size_t& validation_size, const size_t& batch, const size_t& epochs)
+{
+	reserve_training(pool.size(), std::min(batch, std::max(training_size, validation_size)));
+	_order.resize(training_size);
+	_steady_state_allocations = 0;
+	double training_sstot = compute_sstot(training, training_rows, training_size);
+	double validation_sstot = compute_sstot(validation, validation_rows, validation_size);
+	std::unique_ptr<Checkpointer> checkpointer = start_checkpoints();
+	for (size_t i = 0 ; i < epochs ; i++)
+	{
+		if (_shuffle)
+		{
+			if (training_rows)
+				std::copy(training_rows, training_rows + training_size, _order.begin());
+			else
+				std::iota(_order.begin(), _order.end(), 0);
+			shuffle_order(_order, *_urng);
+		}
+		size_t allocations = allocation_count();
+		double training_ssres = 0;
+		double training_loss = 0;
+		process(pool, training, _shuffle ? _order.data() : training_rows, training_size, batch, true, training_loss, training_ssres);
+		double validation_ssres = 0;
+		double validation_loss = 0;
+		process(pool, validation, validation_rows, validation_size, batch, false, validation_loss, validation_ssres);
+		if (i > 0)
+			_steady_state_allocations += allocation_count() - allocations;
+		_history.first[_epoch] = {training_loss / static_cast<double>(training_size), 1.0 - training_ssres / training_sstot};
+		_history.second[_epoch] = {validation_loss / static_cast<double>(validation_size), 1.0 - validation_ssres / validation_sstot};
+		end_epoch(checkpointer.get());
+	}
+	if (checkpointer)
+		checkpointer->finish();
+	return _history;
+}
+
 /**
  * @brief Train the neural network based on a data set
  * 
  * @param loss_functions name of the loss function
  * @param layer_functions name of the activation function used in the hidden layers
  * @param output_functions name of the activation function used in the output layer
- * @param inputs batches of inputs
- * @param outputs batches of outputs we want to reach
+ * @param training examples the network learns from
+ * @param validation examples only used to measure the network
+ * @param batch number of examples per batch, the last one of each set can be smaller
  * @param epochs number of epoch 
+ * @param threads number of threads sharing each batch, the results are
+ * the same from one run to another for a given number of threads
  *
- * @return A pair of map which contains a pair containing the loss and r2 for each epoch
+ * Unless set_shuffle(false) was called, the training examples are batched
+ * in a new order at each epoch, drawn from the generator given to set_urng,
+ * global_urng() by default
+ *
+ * The epochs are counted from get_epoch(), the number of epochs the network
+ * was already trained for. Checkpoints are saved as set_checkpoint asked.
+ *
+ * @return A pair of map which contains a pair containing the loss and r2 for
+ * each epoch the network was trained for, get_history()
  */
-std::pair<std::map<size_t, std::pair<double, double>>, std::map<size_t, std::pair<double, double>>>	ARNetwork::train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions, const std::pair<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<std::vector<double>>>>& inputs, const std::pair<std::vector<std::vector<std::vector<double>>>, std::vector<std::vector<std::vector<double>>>>& outputs, const size_t& epochs)
+ARNetwork::model_measures_type	ARNetwork::train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+	const DatasetView& training, const DatasetView& validation, const size_t& batch, const size_t& epochs, const size_t& threads)
 {
-	if (inputs.first.empty() || inputs.second.empty())
-		throw Error("Error: train or validation inputs are missing");
-	if (outputs.first.empty() || outputs.second.empty())
-		throw Error("Error: train or validation inputs are missing");
-	auto loss_activation = LossFactory::create(loss_functions);
-	_loss_function = loss_functions;
-	_layer_function = layer_functions;
-	_output_function = output_functions;
-	valid_lists(inputs.first, outputs.first, size_inputs(), size_outputs());
-	valid_lists(inputs.second, outputs.second, size_inputs(), size_outputs());
-	model_measures_type track_training;
-	for (size_t i = 0 ; i < epochs ; i++)
-	{
-		process(inputs.first, outputs.first, compute_sstot(outputs.first), track_training.first, i, true);
-		process(inputs.second, outputs.second, compute_sstot(outputs.second), track_training.second, i, false);
-	}
-	return track_training;
+	valid_dataset(training, size_inputs(), size_outputs());
+	valid_dataset(validation, size_inputs(), size_outputs());
+	if (batch == 0)
+		throw Error("Error: batch cannot be 0");
+	set_functions(loss_functions, layer_functions, output_functions);
+	ThreadPool pool(threads);
+	return fit(pool, training, nullptr, training.size(), validation, nullptr, validation.size(), batch, epochs);
 }
 
 /**
- * @brief transform a list of inputs into a list of group of @param batch numbers
+ * @brief Train the neural network on two subsets of the rows of one data set
  * 
- * @param list list of different inputs
- * @param batch size of the groups we want to create
+ * Nothing is copied: batches are gathered from @param datas through the
+ * row indices, so several networks can train on the same read-only data.
  * 
- * @return a list of groups of inputs
+ * @param datas examples of both sets
+ * @param training rows of @param datas the network learns from
+ * @param validation rows of @param datas only used to measure the network
+ *
+ * The other parameters are those of the train overload taking two data sets.
  */
-std::vector<std::vector<std::vector<double>>>	ARNetwork::batching(const std::vector<std::vector<double>>& list, const size_t& batch)
+ARNetwork::model_measures_type	ARNetwork::train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+	const DatasetView& datas, const std::vector<size_t>& training, const std::vector<size_t>& validation, const size_t& batch, const size_t& epochs, const size_t& threads)
 {
+	valid_dataset(datas, size_inputs(), size_outputs());
+	valid_rows(datas, training);
+	valid_rows(datas, validation);
 	if (batch == 0)
 		throw Error("Error: batch cannot be 0");
-	size_t groups = batch > list.size() ? 1 : (size_t)(list.size() / batch);
-	if (batch < list.size())
-		groups += list.size() % batch == 0 ? 0 : 1;
-	batch_type result(groups);
-	size_t index = 0;
-	for (size_t i = 0 ; i < list.size() ; i++)
+	set_functions(loss_functions, layer_functions, output_functions);
+	ThreadPool pool(threads);
+	return fit(pool, datas, training.data(), training.size(), datas, validation.data(), validation.size(), batch, epochs);
+}
+
+/**
+ * @brief Train the neural network on data sets read from disk as it goes
+ * 
+ * Only prefetch + 1 chunks of examples are in memory at once, they are read
+ * by a background thread while the previous one is used. With shuffling
+ * on, the examples are shuffled inside each chunk.
+ * 
+ * @param loss_functions name of the loss function
+ * @param layer_functions name of the activation function used in the hidden layers
+ * @param output_functions name of the activation function used in the output layer
+ * @param training examples the network learns from
+ * @param validation examples only used to measure the network
+ * @param batch number of examples per batch
+ * @param epochs number of epoch 
+ * @param threads number of threads sharing each batch
+ * @param chunk number of examples read at once, rounded up to a multiple of @param batch
+ * @param prefetch number of chunks read ahead
+ *
+ * @return A pair of map which contains a pair containing the loss and r2 for each epoch
+ */
+ARNetwork::model_measures_type	ARNetwork::train(const std::string& loss_functions, const std::string& layer_functions, const std::string& output_functions,
+	IDataSource& training, IDataSource& validation, const size_t& batch, const size_t& epochs, const size_t& threads, const size_t& chunk, const size_t& prefetch)
+{
+	for (const IDataSource *source : {&training, &validation})
+	{
+		if (source->nbr_features() != size_inputs())
+			throw Error("Error: examples must have " + std::to_string(size_inputs()) + " inputs");
+		if (source->nbr_labels() != size_outputs())
+			throw Error("Error: examples must have " + std::to_string(size_outputs()) + " outputs");
+	}
+	if (batch == 0 || chunk == 0)
+		throw Error("Error: batch and chunk cannot be 0");
+	set_functions(loss_functions, layer_functions, output_functions);
+	ThreadPool pool(threads);
+	size_t rows = (chunk + batch - 1) / batch * batch;
+	ChunkReader reader(rows, prefetch);
+	reserve_training(threads, batch);
+	_order.reserve(rows);
+	_steady_state_allocations = 0;
+	std::unique_ptr<Checkpointer> checkpointer = start_checkpoints();
+	for (size_t i = 0 ; i < epochs ; i++)
 	{
-		if (i != 0 && i % batch == 0)
-			index++;
-		result[index].push_back(list[i]);
+		size_t allocations = allocation_count();
+		std::pair<double, double> training_measures = stream(pool, reader, training, batch, true);
+		std::pair<double, double> validation_measures = stream(pool, reader, validation, batch, false);
+		if (i > 0)
+			_steady_state_allocations += allocation_count() - allocations;
+		_history.first[_epoch] = training_measures;
+		_history.second[_epoch] = validation_measures;
+		end_epoch(checkpointer.get());
 	}
-	return result;
+	if (checkpointer)
+		checkpointer->finish();
+	return _history;
 }
 
 void	ARNetwork::randomize_weights(const double& min, const double& max)
@@ -0,0 +1,50 @@
+#include "../include/Allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef ARN_COUNT_ALLOCATIONS
+
+static std::atomic<size_t>	g_allocations(0);
+
+size_t	allocation_count(void) { return g_allocations.load(std::memory_order_relaxed); }
+
+static void	*counted_malloc(const size_t& size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	void *pointer = std::malloc(size ? size : 1);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+static void	*counted_aligned_alloc(const size_t& size, const std::align_val_t& alignment)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	size_t align = static_cast<size_t>(alignment);
+	if (align < sizeof(void *))
+		align = sizeof(void *);
+	void *pointer = nullptr;
+	if (posix_memalign(&pointer, align, size ? size : 1))
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void	*operator new(size_t size) { return counted_malloc(size); }
+void	*operator new[](size_t size) { return counted_malloc(size); }
+void	*operator new(size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+void	*operator new[](size_t size, std::align_val_t alignment) { return counted_aligned_alloc(size, alignment); }
+void	operator delete(void *pointer) noexcept { std::free(pointer); }
+void	operator delete[](void *pointer) noexcept { std::free(pointer); }
+void	operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+void	operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+void	operator delete(void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void	operator delete[](void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void	operator delete(void *pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void	operator delete[](void *pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+#else
+
+size_t	allocation_count(void) { return 0; }
+
+#endif
@@ -0,0 +1,94 @@
+#include "../include/AtomicFile.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#define WRITE_BUFFER (1 << 16)
+
+AtomicFile::AtomicFile(const std::string& file_name)
+	: _file_name(file_name), _temporary(file_name + ".tmp"), _fd(-1), _buffer(WRITE_BUFFER), _size(0)
+{
+	_fd = open(_temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (_fd < 0)
+		throw Error("Error: couldn't open " + _temporary);
+}
+
+AtomicFile::~AtomicFile(void)
+{
+	if (_fd < 0)
+		return ;
+	close(_fd);
+	unlink(_temporary.c_str());
+}
+
+// write @param size bytes to the temporary file, without the buffer
+void	AtomicFile::write_all(const char *data, const size_t& size)
+{
+	for (size_t done = 0 ; done < size ; )
+	{
+		ssize_t written = ::write(_fd, data + done, size - done);
+		if (written < 0 && errno == EINTR)
+			continue ;
+		if (written <= 0)
+			throw Error("Error: couldn't write " + _temporary + ": " + std::strerror(errno));
+		done += written;
+	}
+}
+
+void	AtomicFile::flush(void)
+{
+	write_all(_buffer.data(), _size);
+	_size = 0;
+}
+
+void	AtomicFile::write(const char *data, const size_t& size)
+{
+	if (size > _buffer.size() - _size)
+		flush();
+	if (size >= _buffer.size())
+		write_all(data, size);
+	else
+	{
+		std::memcpy(_buffer.data() + _size, data, size);
+		_size += size;
+	}
+}
+
+// sync the directory holding @param file_name, where its name is
+static void	sync_directory(const std::string& file_name)
+{
+	size_t slash = file_name.find_last_of('/');
+	std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : file_name.substr(0, slash);
+	int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0)
+		throw Error("Error: couldn't open " + directory + ": " + std::strerror(errno));
+	int synced = fsync(fd);
+	std::string error = std::strerror(errno);
+	close(fd);
+	if (synced < 0)
+		throw Error("Error: couldn't sync " + directory + ": " + error);
+}
+
+/**
+ * @brief Put the written file in place of file_name
+ *
+ * The directory is synced after the rename, so the new name survives a
+ * crash too. Nothing can be written after.
+ */
+void	AtomicFile::commit(void)
+{
+	flush();
+	if (fsync(_fd) < 0)
+		throw Error("Error: couldn't write " + _temporary + ": " + std::strerror(errno));
+	int fd = _fd;
+	_fd = -1;
+	if (close(fd) < 0 || std::rename(_temporary.c_str(), _file_name.c_str()) < 0)
+	{
+		std::string error = std::strerror(errno);
+		unlink(_temporary.c_str());
+		throw Error("Error: couldn't write " + _file_name + ": " + error);
+	}
+	sync_directory(_file_name);
+}
@@ -0,0 +1,138 @@
+#include "../include/BinaryDataset.hpp"
+#include "../include/AtomicFile.hpp"
+#include <cstring>
+
+static size_t	align_block(const size_t& offset)
+{
+	return (offset + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
+}
+
+static size_t	labels_offset(const BinaryHeader& header)
+{
+	return align_block(sizeof(BinaryHeader) + header.rows * header.nbr_features * header.value_size);
+}
+
+// check the header of a mapped file and that the file holds every block it announces
+static BinaryHeader	read_header(const MappedFile& file, const std::string& file_name)
+{
+	BinaryHeader header;
+	if (file.size() < sizeof(BinaryHeader))
+		throw Error("Error: " + file_name + " is not a binary dataset");
+	std::memcpy(&header, file.data(), sizeof(BinaryHeader));
+	if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0)
+		throw Error("Error: " + file_name + " is not a binary dataset");
+	if (header.version != BINARY_VERSION)
+		throw Error("Error: " + file_name + " has an unknown version: " + std::to_string(header.version));
+	if (header.value_size != 4 && header.value_size != 8)
+		throw Error("Error: " + file_name + " is corrupted: values of " + std::to_string(header.value_size) + " bytes");
+	if (header.label_encoding > static_cast<uint32_t>(LabelEncoding::OneHot)
+		|| header.nbr_labels != (header.label_encoding == static_cast<uint32_t>(LabelEncoding::OneHot) ? 2u : 1u))
+		throw Error("Error: " + file_name + " is corrupted: wrong label encoding");
+	if (header.nbr_features == 0 || header.nbr_features > file.size())
+		throw Error("Error: " + file_name + " is corrupted: wrong number of features");
+	if (header.rows > file.size() / ((header.nbr_features + header.nbr_labels) * header.value_size)
+		|| labels_offset(header) + header.rows * header.nbr_labels * header.value_size > file.size())
+		throw Error("Error: " + file_name + " is truncated");
+	return header;
+}
+
+// values of [begin, begin + count) stored as float or double, as doubles into @param out
+static void	convert(const char *values, const size_t& value_size, const size_t& begin, const size_t& count, double *out)
+{
+	if (value_size == 8)
+		std::memcpy(out, values + begin * 8, count * 8);
+	else
+	{
+		const float *floats = reinterpret_cast<const float *>(values) + begin;
+		for (size_t i = 0 ; i < count ; i++)
+			out[i] = floats[i];
+	}
+}
+
+static void	write_values(AtomicFile& file, const double *values, const size_t& count, const size_t& value_size)
+{
+	if (value_size == 8)
+	{
+		file.write(reinterpret_cast<const char *>(values), count * 8);
+		return ;
+	}
+	float buffer[1024];
+	for (size_t i = 0 ; i < count ; i += 1024)
+	{
+		size_t size = std::min<size_t>(1024, count - i);
+		for (size_t j = 0 ; j < size ; j++)
+			buffer[j] = static_cast<float>(values[i + j]);
+		file.write(reinterpret_cast<const char *>(buffer), size * 4);
+	}
+}
+
+/**
+ * @brief Write a data set as a binary dataset file
+ *
+ * @param file_name path of the file, replaced at once when it is complete:
+ * a crash while writing leaves the previous one
+ * @param datas examples to write
+ * @param encoding how the labels of @param datas are stored, it must match their number
+ * @param value_size 8 to store the values as float64, 4 as float32
+ */
+void	write_binary(const std::string& file_name, const DatasetView& datas, const LabelEncoding& encoding, const size_t& value_size)
+{
+	if (value_size != 4 && value_size != 8)
+		throw Error("Error: values must be stored on 4 or 8 bytes");
+	if (datas.nbr_labels() != (encoding == LabelEncoding::OneHot ? 2u : 1u))
+		throw Error("Error: the number of labels doesn't match the label encoding");
+	BinaryHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+	header.version = BINARY_VERSION;
+	header.value_size = value_size;
+	header.rows = datas.size();
+	header.nbr_features = datas.nbr_features();
+	header.nbr_labels = datas.nbr_labels();
+	header.label_encoding = static_cast<uint32_t>(encoding);
+	AtomicFile file(file_name);
+	const char padding[BINARY_ALIGNMENT] = {};
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	write_values(file, datas.features(), datas.size() * datas.nbr_features(), value_size);
+	file.write(padding, labels_offset(header) - sizeof(header) - datas.size() * datas.nbr_features() * value_size);
+	write_values(file, datas.labels(), datas.size() * datas.nbr_labels(), value_size);
+	file.commit();
+}
+
+/**
+ * @brief Map a binary dataset file
+ *
+ * @param file_name path of a file written by write_binary
+ */
+BinaryDataset::BinaryDataset(const std::string& file_name)
+	: _file(file_name), _header(read_header(_file, file_name)), _view(nullptr, nullptr, 0, _header.nbr_features, _header.nbr_labels)
+{
+	const char *features = _file.data() + sizeof(BinaryHeader);
+	const char *labels = _file.data() + labels_offset(_header);
+	if (_header.value_size == 8)
+	{
+		_view = DatasetView(reinterpret_cast<const double *>(features), reinterpret_cast<const double *>(labels),
+			_header.rows, _header.nbr_features, _header.nbr_labels);
+		return ;
+	}
+	_converted = Dataset(_header.nbr_features, _header.nbr_labels);
+	_converted.resize(_header.rows);
+	convert(features, 4, 0, _header.rows * _header.nbr_features, _converted.features());
+	convert(labels, 4, 0, _header.rows * _header.nbr_labels, _converted.labels());
+	_view = _converted;
+}
+
+BinarySource::BinarySource(const std::string& file_name)
+	: _file(file_name), _header(read_header(_file, file_name)), _row(0) {}
+
+size_t	BinarySource::read(Dataset& chunk, const size_t& rows)
+{
+	if (chunk.nbr_features() != nbr_features() || chunk.nbr_labels() != nbr_labels())
+		chunk = Dataset(nbr_features(), nbr_labels());
+	size_t count = std::min<size_t>(rows, _header.rows - _row);
+	chunk.resize(count);
+	convert(_file.data() + sizeof(BinaryHeader), _header.value_size, _row * _header.nbr_features, count * _header.nbr_features, chunk.features());
+	convert(_file.data() + labels_offset(_header), _header.value_size, _row * _header.nbr_labels, count * _header.nbr_labels, chunk.labels());
+	_row += count;
+	return count;
+}
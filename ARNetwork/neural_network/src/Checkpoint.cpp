@@ -0,0 +1,130 @@
+#include "../include/Checkpoint.hpp"
+#include "../include/ARNetwork.hpp"
+
+// copy what @param network trains into @param state, reusing its buffers when the shapes match
+static void	snapshot(TrainingState& state, const ARNetwork& network)
+{
+	const std::vector<Matrix<double>>& weights = network.get_weights();
+	const std::vector<Vector<double>>& bias = network.get_bias();
+	state.weights.resize(weights.size());
+	state.bias.resize(bias.size());
+	for (size_t i = 0 ; i < weights.size() ; i++)
+	{
+		if (state.weights[i].getNbrLines() != weights[i].getNbrLines() || state.weights[i].getNbrColumns() != weights[i].getNbrColumns())
+			state.weights[i].resize(weights[i].getNbrLines(), weights[i].getNbrColumns());
+		std::copy(weights[i].data(), weights[i].data() + weights[i].getNbrLines() * weights[i].getStride(), state.weights[i].data());
+		if (state.bias[i].dimension() != bias[i].dimension())
+			state.bias[i] = Vector<double>(bias[i].dimension());
+		std::copy(bias[i].data(), bias[i].data() + bias[i].dimension(), state.bias[i].data());
+	}
+	state.learning_rate = network.get_learning_rate();
+	state.loss_function = network.get_loss_function();
+	state.layer_function = network.get_layer_function();
+	state.output_function = network.get_output_function();
+	state.epoch = network.get_epoch();
+	state.urng = network.get_urng();
+	state.history = network.get_history();
+}
+
+/**
+ * @brief Write the state of the training of the network, now
+ *
+ * ARNetwork(file_name) loads it back, with the generator of the training.
+ */
+void	ARNetwork::save_checkpoint(const std::string& file_name) const
+{
+	TrainingState state;
+	snapshot(state, *this);
+	write_checkpoint(file_name, state);
+}
+
+/**
+ * @param settings where and how often to save
+ * @param network network being trained, whose shape sizes the two states
+ */
+Checkpointer::Checkpointer(const CheckpointSettings& settings, const ARNetwork& network)
+	: _settings(settings), _pending(-1), _writing(-1), _stop(false), _last(clock::now())
+{
+	if (settings.file_name.empty())
+		throw Error("Error: a checkpoint needs a file");
+	for (auto& state : _states)
+		snapshot(state, network);
+	_thread = std::thread(&Checkpointer::work, this);
+}
+
+// write what is still pending, then stop
+Checkpointer::~Checkpointer(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_changed.notify_all();
+	_thread.join();
+}
+
+void	Checkpointer::work(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_changed.wait(lock, [&] { return _stop || _pending >= 0; });
+		if (_pending < 0)
+			return ;
+		_writing = _pending;
+		_pending = -1;
+		const TrainingState& state = _states[_writing];
+		lock.unlock();
+		std::exception_ptr error;
+		try { write_checkpoint(_settings.file_name, state); }
+		catch (...) { error = std::current_exception(); }
+		lock.lock();
+		if (error)
+			_error = error;
+		_writing = -1;
+		_changed.notify_all();
+	}
+}
+
+// @return true if a checkpoint should be saved once @param epoch epochs are done
+bool	Checkpointer::due(const size_t& epoch) const
+{
+	if (_settings.epochs && epoch % _settings.epochs == 0)
+		return true;
+	return _settings.seconds > 0 && std::chrono::duration<double>(clock::now() - _last).count() >= _settings.seconds;
+}
+
+/**
+ * @brief Snapshot @param network and hand it to the background thread
+ *
+ * Throws the error of a previous write, if one failed.
+ */
+void	Checkpointer::save(const ARNetwork& network)
+{
+	int index;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_error)
+			std::rethrow_exception(_error);
+		// the state which isn't being written, pending or free
+		index = _writing == 0 ? 1 : 0;
+		if (_pending == index)
+			_pending = -1;
+	}
+	snapshot(_states[index], network);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pending = index;
+	}
+	_changed.notify_all();
+	_last = clock::now();
+}
+
+// wait until every snapshot is on the disk, throws if a write failed
+void	Checkpointer::finish(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_changed.wait(lock, [&] { return _pending < 0 && _writing < 0; });
+	if (_error)
+		std::rethrow_exception(_error);
+}
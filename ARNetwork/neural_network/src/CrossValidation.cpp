@@ -0,0 +1,62 @@
+#include "../include/CrossValidation.hpp"
+
+// mean and unbiased variance of @param values
+static std::pair<double, double>	mean_variance(const std::vector<double>& values)
+{
+	double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+	double squares = 0;
+	for (const double& value : values)
+		squares += (value - mean) * (value - mean);
+	return {mean, values.size() > 1 ? squares / static_cast<double>(values.size() - 1) : 0};
+}
+
+/**
+ * @brief Train a copy of @param model on each fold at the same time
+ *
+ * Every fold trains its own replica of the model, with the same initial
+ * weights and functions, on rows of the one read-only @param datas: no
+ * example is copied. Each replica shuffles with its own generator, seeded
+ * from global_urng() before the folds start, so a seeded run gives the
+ * same report whatever the number of threads.
+ *
+ * @param model network the folds start from, it isn't modified
+ * @param datas examples of every fold
+ * @param folds training and validation rows of each fold
+ * @param batch number of examples per batch
+ * @param epochs number of epoch of each fold
+ * @param threads number of folds trained at once
+ */
+CrossValidationReport	cross_validate(const ARNetwork& model, const DatasetView& datas, const std::vector<SplitIndices>& folds,
+	const size_t& batch, const size_t& epochs, const size_t& threads)
+{
+	if (folds.empty())
+		throw Error("Error: cross validation needs at least one fold");
+	if (epochs == 0)
+		throw Error("Error: epoch must be a non null positive integer");
+	std::vector<std::mt19937> urngs;
+	for (size_t i = 0 ; i < folds.size() ; i++)
+		urngs.emplace_back(global_urng()());
+	CrossValidationReport report;
+	report.folds.resize(folds.size());
+	ThreadPool pool(std::min(threads, folds.size()));
+	auto fold = [&](const size_t& i)
+	{
+		ARNetwork replica(model);
+		replica.set_urng(urngs[i]);
+		auto tracking = replica.train(model.get_loss_function(), model.get_layer_function(), model.get_output_function(),
+			datas, folds[i].training, folds[i].validation, batch, epochs);
+		report.folds[i].training = tracking.first.rbegin()->second;
+		report.folds[i].validation = tracking.second.rbegin()->second;
+	};
+	pool.run(folds.size(), fold);
+	std::vector<double> losses;
+	std::vector<double> r2s;
+	for (const auto& result : report.folds)
+	{
+		losses.push_back(result.validation.first);
+		r2s.push_back(result.validation.second);
+	}
+	std::tie(report.loss_mean, report.loss_variance) = mean_variance(losses);
+	std::tie(report.r2_mean, report.r2_variance) = mean_variance(r2s);
+	return report;
+}
@@ -0,0 +1,264 @@
+#include "../include/Csv.hpp"
+#include "../include/MappedFile.hpp"
+#include "../include/ThreadPool.hpp"
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+/*
+ * The mapped file is cut in one chunk per thread, each chunk ending on a
+ * line end. A first parallel pass counts the examples of every chunk, which
+ * gives where each chunk writes in the dataset; a second one parses and
+ * checks every line straight into its row. Errors are kept per chunk and
+ * the one of the earliest line is reported.
+ */
+
+// below this size a chunk isn't worth a thread
+#define MIN_CHUNK (1 << 20)
+
+struct	Chunk
+{
+	const char	*begin;
+	const char	*end;
+	size_t		first_line;
+	size_t		lines;
+	size_t		first_row;
+	size_t		rows;
+	std::string	error;
+};
+
+// [line, line end) without the line break, and the start of the next line
+static const char	*next_line(const char *line, const char *end, const char *&line_end)
+{
+	const char *newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+	line_end = newline ? newline : end;
+	if (line_end > line && line_end[-1] == '\r')
+		line_end--;
+	return newline ? newline + 1 : end;
+}
+
+static void	count(Chunk& chunk)
+{
+	chunk.lines = 0;
+	chunk.rows = 0;
+	for (const char *line = chunk.begin, *line_end ; line < chunk.end ; chunk.lines++)
+	{
+		const char *next = next_line(line, chunk.end, line_end);
+		if (line_end != line)
+			chunk.rows++;
+		line = next;
+	}
+}
+
+static bool	parse_label(const char *field, const char *end, double& label)
+{
+	if (end - field == 1 && (*field == 'M' || *field == 'B'))
+	{
+		label = *field == 'M' ? 1 : 0;
+		return true;
+	}
+	std::from_chars_result result = std::from_chars(field, end, label);
+	return result.ec == std::errc() && result.ptr == end && (label == 0 || label == 1);
+}
+
+// @return the column in @param line of the first wrong character of the number in [field, end), or -1
+static long	parse_number(const char *line, const char *field, const char *end, double& value)
+{
+	std::from_chars_result result = std::from_chars(field, end, value);
+	if (result.ec != std::errc() || result.ptr != end)
+		return (result.ec == std::errc() ? result.ptr : field) - line;
+	if (!std::isfinite(value))
+		return field - line;
+	return -1;
+}
+
+// @return the column of the first wrong character, or -1 if the line is valid
+static long	parse_line(const char *line, const char *end, const CsvFormat& format, double *features, double *labels)
+{
+	size_t label_column = format.labeled ? format.skip : SIZE_MAX;
+	size_t first_feature = format.skip + format.labeled;
+	size_t columns = first_feature + format.nbr_features;
+	size_t column = 0;
+	if (!format.labeled)
+		std::fill(labels, labels + (format.one_hot ? 2 : 1), 0.0);
+	for (const char *field = line ; ; column++)
+	{
+		const char *comma = static_cast<const char *>(std::memchr(field, ',', end - field));
+		const char *field_end = comma ? comma : end;
+		if (column >= columns)
+			return field - line;
+		if (column == label_column)
+		{
+			double label;
+			if (!parse_label(field, field_end, label))
+				return field - line;
+			if (format.one_hot)
+			{
+				labels[0] = 1 - label;
+				labels[1] = label;
+			}
+			else
+				labels[0] = label;
+		}
+		else
+		{
+			// a skipped column is checked like a feature, then dropped
+			double skipped;
+			long error = parse_number(line, field, field_end, column >= first_feature ? features[column - first_feature] : skipped);
+			if (error >= 0)
+				return error;
+		}
+		if (!comma)
+			break ;
+		field = comma + 1;
+	}
+	if (column + 1 != columns)
+		return end - line;
+	return -1;
+}
+
+static void	parse(Chunk& chunk, const CsvFormat& format, Dataset& datas, const std::string& file_name)
+{
+	size_t row = chunk.first_row;
+	size_t index = chunk.first_line;
+	for (const char *line = chunk.begin, *line_end ; line < chunk.end ; index++)
+	{
+		const char *next = next_line(line, chunk.end, line_end);
+		if (line_end != line)
+		{
+			long column = parse_line(line, line_end, format, datas.features(row), datas.labels(row));
+			if (column >= 0)
+			{
+				chunk.error = "Error: " + file_name + " is corrupted: line " + std::to_string(index) + " column " + std::to_string(column);
+				return ;
+			}
+			row++;
+		}
+		line = next;
+	}
+}
+
+/**
+ * @brief Load every example of a CSV file into a Dataset
+ *
+ * The file is mapped in memory and parsed by several threads at once with
+ * std::from_chars, which doesn't depend on the locale. Each line is checked
+ * while it is parsed.
+ *
+ * @param file_name path of the CSV file
+ * @param format layout of the lines
+ *
+ * @return a dataset of format.nbr_features features and 1 label, 2 if format.one_hot
+ */
+Dataset	read_csv(const std::string& file_name, const CsvFormat& format)
+{
+	if (format.nbr_features == 0)
+		throw Error("Error: an example needs at least one feature");
+	MappedFile file(file_name);
+	Dataset datas(format.nbr_features, format.one_hot ? 2 : 1);
+	if (file.size() == 0)
+		return datas;
+	size_t threads = format.threads ? format.threads : std::max(1u, std::thread::hardware_concurrency());
+	size_t nbr_chunks = std::max<size_t>(1, std::min(threads, file.size() / MIN_CHUNK));
+	std::vector<Chunk> chunks(nbr_chunks);
+	const char *begin = file.data();
+	const char *end = file.data() + file.size();
+	for (size_t i = 0 ; i < nbr_chunks ; i++)
+	{
+		chunks[i].begin = i ? chunks[i - 1].end : begin;
+		chunks[i].end = i + 1 == nbr_chunks ? end : file.data() + file.size() * (i + 1) / nbr_chunks;
+		chunks[i].end = std::max(chunks[i].end, chunks[i].begin);
+		const char *newline = static_cast<const char *>(std::memchr(chunks[i].end, '\n', end - chunks[i].end));
+		if (chunks[i].end != end)
+			chunks[i].end = newline ? newline + 1 : end;
+	}
+	ThreadPool pool(std::min(threads, nbr_chunks));
+	auto counting = [&](const size_t& i) { count(chunks[i]); };
+	pool.run(nbr_chunks, counting);
+	size_t rows = 0;
+	size_t lines = 0;
+	for (auto& chunk : chunks)
+	{
+		chunk.first_row = rows;
+		chunk.first_line = lines;
+		rows += chunk.rows;
+		lines += chunk.lines;
+	}
+	datas.resize(rows);
+	auto parsing = [&](const size_t& i) { parse(chunks[i], format, datas, file_name); };
+	pool.run(nbr_chunks, parsing);
+	for (const auto& chunk : chunks)
+		if (!chunk.error.empty())
+			throw Error(chunk.error);
+	return datas;
+}
+
+// size of the read buffer of CsvSource, it grows if a line doesn't fit
+#define READ_BUFFER (1 << 20)
+
+CsvSource::CsvSource(const std::string& file_name, const CsvFormat& format)
+	: _file_name(file_name), _format(format), _file(file_name, std::ios::binary), _buffer(READ_BUFFER), _begin(0), _end(0), _line(0)
+{
+	if (!_file)
+		throw Error("Error: couldn't open " + file_name);
+	if (format.nbr_features == 0)
+		throw Error("Error: an example needs at least one feature");
+}
+
+void	CsvSource::rewind(void)
+{
+	_file.clear();
+	_file.seekg(0);
+	_begin = 0;
+	_end = 0;
+	_line = 0;
+}
+
+// read more of the file after what is left in the buffer, @return false at the end of the file
+bool	CsvSource::fill(void)
+{
+	if (!_file)
+		return false;
+	std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+	_end -= _begin;
+	_begin = 0;
+	if (_end == _buffer.size())
+		_buffer.resize(_buffer.size() * 2);
+	_file.read(_buffer.data() + _end, _buffer.size() - _end);
+	_end += _file.gcount();
+	return _file.gcount() > 0;
+}
+
+size_t	CsvSource::read(Dataset& chunk, const size_t& rows)
+{
+	if (chunk.nbr_features() != nbr_features() || chunk.nbr_labels() != nbr_labels())
+		chunk = Dataset(nbr_features(), nbr_labels());
+	chunk.resize(rows);
+	size_t row = 0;
+	while (row < rows)
+	{
+		const char *begin = _buffer.data() + _begin;
+		const char *end = _buffer.data() + _end;
+		const char *newline = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+		if (!newline && fill())
+			continue ;
+		if (!newline && begin == end)
+			break ;
+		const char *line_end;
+		const char *next = next_line(begin, end, line_end);
+		if (line_end != begin)
+		{
+			long column = parse_line(begin, line_end, _format, chunk.features(row), chunk.labels(row));
+			if (column >= 0)
+				throw Error("Error: " + _file_name + " is corrupted: line " + std::to_string(_line) + " column " + std::to_string(column));
+			row++;
+		}
+		_begin = next - _buffer.data();
+		_line++;
+	}
+	chunk.resize(row);
+	return row;
+}
@@ -0,0 +1,99 @@
+#include "../include/DataSource.hpp"
+
+/**
+ * @param chunk_rows number of examples read at once
+ * @param prefetch number of chunks read ahead of the one being used
+ */
+ChunkReader::ChunkReader(const size_t& chunk_rows, const size_t& prefetch)
+	: _slots(prefetch + 1), _chunk_rows(chunk_rows), _head(0), _count(0), _holding(false), _ended(false), _reading(false), _stop(false), _source(nullptr)
+{
+	if (chunk_rows == 0)
+		throw Error("Error: chunk cannot be 0");
+	if (prefetch == 0)
+		throw Error("Error: prefetch cannot be 0");
+	_thread = std::thread(&ChunkReader::work, this);
+}
+
+ChunkReader::~ChunkReader(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_changed.notify_all();
+	_thread.join();
+}
+
+void	ChunkReader::work(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_changed.wait(lock, [&] { return _stop || (_source && !_ended && _count < _slots.size()); });
+		if (_stop)
+			return ;
+		Dataset& slot = _slots[(_head + _count) % _slots.size()];
+		IDataSource& source = *_source;
+		_reading = true;
+		lock.unlock();
+		size_t rows = 0;
+		std::exception_ptr error;
+		try { rows = source.read(slot, _chunk_rows); }
+		catch (...) { error = std::current_exception(); }
+		lock.lock();
+		_reading = false;
+		// a chunk of a pass stopped by start() is dropped
+		if (_source == &source && (error || rows == 0))
+		{
+			_error = error;
+			_ended = true;
+			_source = nullptr;
+		}
+		else if (_source == &source)
+			_count++;
+		_changed.notify_all();
+	}
+}
+
+/**
+ * @brief Begin a pass over every example of @param source
+ *
+ * The chunks of the previous pass which weren't consumed are dropped.
+ */
+void	ChunkReader::start(IDataSource& source)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_source = nullptr;
+	_changed.wait(lock, [&] { return !_reading; });
+	source.rewind();
+	_head = 0;
+	_count = 0;
+	_holding = false;
+	_ended = false;
+	_error = nullptr;
+	_source = &source;
+	_changed.notify_all();
+}
+
+/**
+ * @return the next chunk of the pass, valid until the following call, or
+ * nullptr once the whole source was read
+ */
+const Dataset	*ChunkReader::next(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (_holding)
+	{
+		_head = (_head + 1) % _slots.size();
+		_count--;
+		_holding = false;
+		_changed.notify_all();
+	}
+	_changed.wait(lock, [&] { return _count > 0 || _ended || _error; });
+	if (_error)
+		std::rethrow_exception(_error);
+	if (_count == 0)
+		return nullptr;
+	_holding = true;
+	return &_slots[_head];
+}
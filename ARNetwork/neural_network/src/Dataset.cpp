@@ -0,0 +1,111 @@
+#include "../include/Dataset.hpp"
+
+// view over every example of @param datas
+DatasetView::DatasetView(const Dataset& datas)
+	: _features(datas.features()), _labels(datas.labels()), _size(datas.size()), _nbr_features(datas.nbr_features()), _nbr_labels(datas.nbr_labels()) {}
+
+/**
+ * @brief Construct an empty data set
+ *
+ * @param nbr_features number of values given to the network for each example
+ * @param nbr_labels number of values expected from the network for each example
+ */
+Dataset::Dataset(const size_t& nbr_features, const size_t& nbr_labels) : _nbr_features(nbr_features), _nbr_labels(nbr_labels)
+{
+	if (nbr_features == 0 || nbr_labels == 0)
+		throw Error("Error: an example needs at least one feature and one label");
+}
+
+/**
+ * @brief Construct a data set by copying a list of examples
+ *
+ * @param features features of each example, they must all have the same size
+ * @param labels labels of each example, they must all have the same size
+ */
+Dataset::Dataset(const std::vector<std::vector<double>>& features, const std::vector<std::vector<double>>& labels)
+{
+	if (features.empty() || features.size() != labels.size())
+		throw Error("Error: features and labels must hold the same non null number of examples");
+	*this = Dataset(features[0].size(), labels[0].size());
+	reserve(features.size());
+	for (size_t i = 0 ; i < features.size() ; i++)
+		push_back(features[i], labels[i]);
+}
+
+void	Dataset::reserve(const size_t& rows)
+{
+	_features.reserve(rows * _nbr_features);
+	_labels.reserve(rows * _nbr_labels);
+}
+
+// new rows are filled with zeros
+void	Dataset::resize(const size_t& rows)
+{
+	_features.resize(rows * _nbr_features);
+	_labels.resize(rows * _nbr_labels);
+}
+
+void	Dataset::push_back(const double *features, const double *labels)
+{
+	if (_nbr_features == 0)
+		throw Error("Error: the size of the examples is unknown");
+	_features.insert(_features.end(), features, features + _nbr_features);
+	_labels.insert(_labels.end(), labels, labels + _nbr_labels);
+}
+
+void	Dataset::push_back(const std::vector<double>& features, const std::vector<double>& labels)
+{
+	if (features.size() != _nbr_features)
+		throw Error("Error: example " + std::to_string(size()) + " must have " + std::to_string(_nbr_features) + " features");
+	if (labels.size() != _nbr_labels)
+		throw Error("Error: example " + std::to_string(size()) + " must have " + std::to_string(_nbr_labels) + " labels");
+	push_back(features.data(), labels.data());
+}
+
+/**
+ * @return a view over the examples [offset, offset + count)
+ */
+DatasetView	Dataset::view(const size_t& offset, const size_t& count) const
+{
+	if (offset > size() || count > size() - offset)
+		throw Error("Error: index out of range");
+	return DatasetView(features(offset), labels(offset), count, _nbr_features, _nbr_labels);
+}
+
+/**
+ * @return the @param index th group of @param batch examples, the last one can be smaller
+ */
+DatasetView	Dataset::batch(const size_t& index, const size_t& batch) const
+{
+	if (batch == 0)
+		throw Error("Error: batch cannot be 0");
+	size_t offset = index * batch;
+	return view(offset, std::min(batch, size() - std::min(offset, size())));
+}
+
+size_t	Dataset::nbr_batches(const size_t& batch) const
+{
+	if (batch == 0)
+		throw Error("Error: batch cannot be 0");
+	return (size() + batch - 1) / batch;
+}
+
+/**
+ * @brief Fisher-Yates shuffle of @param order
+ *
+ * The draws only go through the engine, so a given seed gives the same
+ * permutation whatever the standard library.
+ */
+void	shuffle_order(std::vector<size_t>& order, std::mt19937& urng)
+{
+	for (size_t i = order.size() ; i > 1 ; i--)
+	{
+		// rejection keeps the draw uniform in [0, i)
+		uint64_t limit = (uint64_t(1) << 32) - (uint64_t(1) << 32) % i;
+		uint64_t draw;
+		do
+			draw = urng();
+		while (draw >= limit);
+		std::swap(order[i - 1], order[draw % i]);
+	}
+}
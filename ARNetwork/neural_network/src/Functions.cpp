@@ -108,4 +108,225 @@ std::unique_ptr<ILoss>	LossFactory::create(const std::string& function)
 	if (function == "mse") return std::make_unique<MSE>();
 	if (function == "bce") return std::make_unique<BCE>();
 	throw Error("Error: unknown loss function: " + function);
-}
\ No newline at end of file
+}
+
+Activation	activation_from_name(const std::string& function)
+{
+	if (function == "relu") return Activation::ReLU;
+	if (function == "sigmoid") return Activation::Sigmoid;
+	if (function == "tanh") return Activation::TanH;
+	if (function == "leakyrelu") return Activation::LeakyReLU;
+	if (function == "identity") return Activation::Identity;
+	if (function == "softmax") return Activation::SoftMax;
+	throw Error("Error: unknown activation function: " + function);
+}
+
+Loss	loss_from_name(const std::string& function)
+{
+	if (function == "mse") return Loss::MSE;
+	if (function == "bce") return Loss::BCE;
+	throw Error("Error: unknown loss function: " + function);
+}
+
+typedef void	(*kernel_type)(const double *, double *, const size_t&);
+
+// run a contiguous kernel over every line, at once when there is no padding
+static void	map(const kernel_type& kernel, const double *in, double *out, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	if (stride == columns)
+		return kernel(in, out, lines * columns);
+	for (size_t i = 0 ; i < lines ; i++)
+		kernel(in + i * stride, out + i * stride, columns);
+}
+
+#define SOFTMAX_BLOCK 64
+
+/*
+ * Columns are handled SOFTMAX_BLOCK at a time so the maxima and sums stay
+ * on the stack, and exp always runs along a line where values are contiguous
+ */
+static void	softmax(const double *z, double *a, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	if (columns == 1 && stride == 1)
+	{
+		double maxVal = *std::max_element(z, z + lines);
+		for (size_t i = 0 ; i < lines ; i++)
+			a[i] = z[i] - maxVal;
+		exp_kernel(a, a, lines);
+		double sumExp = 0.0;
+		for (size_t i = 0 ; i < lines ; i++)
+			sumExp += a[i];
+		for (size_t i = 0 ; i < lines ; i++)
+			a[i] /= sumExp;
+		return ;
+	}
+	double maxVal[SOFTMAX_BLOCK];
+	double sumExp[SOFTMAX_BLOCK];
+	for (size_t first = 0 ; first < columns ; first += SOFTMAX_BLOCK)
+	{
+		size_t width = std::min<size_t>(SOFTMAX_BLOCK, columns - first);
+		for (size_t j = 0 ; j < width ; j++)
+		{
+			maxVal[j] = z[first + j];
+			sumExp[j] = 0.0;
+		}
+		for (size_t i = 1 ; i < lines ; i++)
+			for (size_t j = 0 ; j < width ; j++)
+				maxVal[j] = std::max(maxVal[j], z[i * stride + first + j]);
+		for (size_t i = 0 ; i < lines ; i++)
+		{
+			double *line = a + i * stride + first;
+			for (size_t j = 0 ; j < width ; j++)
+				line[j] = z[i * stride + first + j] - maxVal[j];
+			exp_kernel(line, line, width);
+			for (size_t j = 0 ; j < width ; j++)
+				sumExp[j] += line[j];
+		}
+		for (size_t i = 0 ; i < lines ; i++)
+			for (size_t j = 0 ; j < width ; j++)
+				a[i * stride + first + j] /= sumExp[j];
+	}
+}
+
+void	activate(const Activation& function, const double *z, double *a, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	switch (function)
+	{
+		case Activation::ReLU:
+			return map(relu_kernel, z, a, lines, columns, stride);
+		case Activation::Sigmoid:
+			return map(sigmoid_kernel, z, a, lines, columns, stride);
+		case Activation::TanH:
+			return map(tanh_kernel, z, a, lines, columns, stride);
+		case Activation::LeakyReLU:
+			return map(leaky_relu_kernel, z, a, lines, columns, stride);
+		case Activation::Identity:
+			return map(identity_kernel, z, a, lines, columns, stride);
+		case Activation::SoftMax:
+			return softmax(z, a, lines, columns, stride);
+	}
+}
+
+void	derive_output(const Activation& function, const double *a, double *d, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	switch (function)
+	{
+		case Activation::ReLU:
+			return map(relu_derive_output_kernel, a, d, lines, columns, stride);
+		case Activation::Sigmoid:
+		case Activation::SoftMax:
+			return map(sigmoid_derive_output_kernel, a, d, lines, columns, stride);
+		case Activation::TanH:
+			return map(tanh_derive_output_kernel, a, d, lines, columns, stride);
+		case Activation::LeakyReLU:
+			return map(leaky_relu_derive_output_kernel, a, d, lines, columns, stride);
+		case Activation::Identity:
+			return map(identity_derive_output_kernel, a, d, lines, columns, stride);
+	}
+}
+
+// one activation pass into d, then the derivative is taken from it in place
+void	derive(const Activation& function, const double *z, double *d, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	activate(function, z, d, lines, columns, stride);
+	derive_output(function, d, d, lines, columns, stride);
+}
+
+static double	clamp_probability(const double& x)
+{
+	if (x < std::numeric_limits<double>::epsilon())
+		return std::numeric_limits<double>::epsilon();
+	if (x > 1 - std::numeric_limits<double>::epsilon())
+		return 1 - std::numeric_limits<double>::epsilon();
+	return x;
+}
+
+/**
+ * @return the sum over the columns of the loss of each example
+ */
+double	loss(const Loss& function, const double *a, const double *y, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	double sum = 0;
+	for (size_t i = 0 ; i < lines ; i++)
+	{
+		for (size_t j = 0 ; j < columns ; j++)
+		{
+			double a_ij = a[i * stride + j];
+			double y_ij = y[i * stride + j];
+			if (function == Loss::MSE)
+				sum += (a_ij - y_ij) * (a_ij - y_ij);
+			else
+			{
+				double y_hat = clamp_probability(a_ij);
+				sum += y_ij * std::log(y_hat) + (1 - y_ij) * std::log(1 - y_hat);
+			}
+		}
+	}
+	if (function == Loss::MSE)
+		return sum / (2.0 * static_cast<double>(lines));
+	return -sum / static_cast<double>(lines);
+}
+
+void	derive_loss(const Loss& function, const double *a, const double *y, double *gradients, const size_t& lines, const size_t& columns, const size_t& stride)
+{
+	for (size_t i = 0 ; i < lines ; i++)
+	{
+		for (size_t j = 0 ; j < columns ; j++)
+		{
+			double a_ij = a[i * stride + j];
+			double y_ij = y[i * stride + j];
+			if (function == Loss::MSE)
+				gradients[i * stride + j] = (a_ij - y_ij) / lines;
+			else
+			{
+				double y_hat = clamp_probability(a_ij);
+				gradients[i * stride + j] = (y_hat - y_ij) / (y_hat * (1.0 - y_hat) * lines);
+			}
+		}
+	}
+}
+
+static void	same_shape(const Matrix<double>& a, Matrix<double>& b)
+{
+	if (a.getNbrLines() != b.getNbrLines() || a.getNbrColumns() != b.getNbrColumns())
+		b.resize(a.getNbrLines(), a.getNbrColumns());
+}
+
+static void	valid_shapes(const Matrix<double>& a, const Matrix<double>& b)
+{
+	if (a.empty() || b.empty())
+		throw Error("Error: matrix is empty");
+	if (a.getNbrLines() != b.getNbrLines() || a.getNbrColumns() != b.getNbrColumns())
+		throw Error("Error: matrices must have the same dimensions");
+}
+
+void	activate(const Activation& function, const Matrix<double>& z, Matrix<double>& a)
+{
+	same_shape(z, a);
+	activate(function, z.data(), a.data(), z.getNbrLines(), z.getNbrColumns(), z.getStride());
+}
+
+void	derive(const Activation& function, const Matrix<double>& z, Matrix<double>& d)
+{
+	same_shape(z, d);
+	derive(function, z.data(), d.data(), z.getNbrLines(), z.getNbrColumns(), z.getStride());
+}
+
+void	derive_output(const Activation& function, const Matrix<double>& a, Matrix<double>& d)
+{
+	same_shape(a, d);
+	derive_output(function, a.data(), d.data(), a.getNbrLines(), a.getNbrColumns(), a.getStride());
+}
+
+double	loss(const Loss& function, const Matrix<double>& a, const Matrix<double>& y)
+{
+	valid_shapes(a, y);
+	return loss(function, a.data(), y.data(), a.getNbrLines(), a.getNbrColumns(), a.getStride());
+}
+
+void	derive_loss(const Loss& function, const Matrix<double>& a, const Matrix<double>& y, Matrix<double>& gradients)
+{
+	valid_shapes(a, y);
+	same_shape(a, gradients);
+	derive_loss(function, a.data(), y.data(), gradients.data(), a.getNbrLines(), a.getNbrColumns(), a.getStride());
+}
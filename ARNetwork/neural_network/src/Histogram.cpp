@@ -0,0 +1,31 @@
+#include "../include/Histogram.hpp"
+
+void	Histogram::record(const size_t& value)
+{
+	size_t bucket = 0;
+	for (size_t bound = 1 ; bound <= value ; bound <<= 1)
+		bucket++;
+	if (bucket >= _buckets.size())
+		_buckets.resize(bucket + 1);
+	_buckets[bucket]++;
+	_count++;
+	_sum += value;
+	_max = std::max(_max, value);
+}
+
+// one line per non empty bucket: its range, its count and a bar
+void	Histogram::display(std::ostream& out, const std::string& name) const
+{
+	out << name << ": " << _count << " values, mean = " << mean() << " max = " << _max << std::endl;
+	size_t highest = *std::max_element(_buckets.begin(), _buckets.end());
+	for (size_t i = 0 ; i < _buckets.size() ; i++)
+	{
+		if (_buckets[i] == 0)
+			continue ;
+		size_t low = i ? size_t(1) << (i - 1) : 0;
+		size_t high = i ? (size_t(1) << i) - 1 : 0;
+		std::string range = low == high ? std::to_string(low) : std::to_string(low) + "-" + std::to_string(high);
+		out << "  " << range << std::string(range.size() < 12 ? 12 - range.size() : 1, ' ') << _buckets[i] << "\t"
+			<< std::string(40 * _buckets[i] / highest, '#') << std::endl;
+	}
+}
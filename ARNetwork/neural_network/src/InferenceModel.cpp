@@ -0,0 +1,125 @@
+#include "../include/InferenceModel.hpp"
+
+InferenceScratch::InferenceScratch(const InferenceModel& model, const size_t& batch) : _capacity(0)
+{
+	reserve(model, batch);
+}
+
+// allocate the buffers for batches of up to @param batch examples
+void	InferenceScratch::reserve(const InferenceModel& model, const size_t& batch)
+{
+	if (batch == 0)
+		throw Error("Error: batch cannot be 0");
+	const std::vector<size_t>& topology = model.topology();
+	_a = std::vector<Matrix<double>>(topology.size());
+	for (size_t l = 0 ; l < topology.size() ; l++)
+		_a[l].resize(topology[l], batch);
+	_z.resize(*std::max_element(topology.begin() + 1, topology.end()), batch);
+	_capacity = batch;
+}
+
+namespace
+{
+	struct	Parameters
+	{
+		std::vector<Matrix<double>>	weights;
+		std::vector<Vector<double>>	bias;
+	};
+}
+
+/**
+ * @brief Copy the weights, bias and functions of @param network
+ *
+ * The model doesn't follow later changes of the network.
+ */
+InferenceModel::InferenceModel(const ARNetwork& network)
+	: _topology(network.topology()),
+	_layer_activation(activation_from_name(network.get_layer_function())), _output_activation(activation_from_name(network.get_output_function()))
+{
+	std::shared_ptr<Parameters> parameters = std::make_shared<Parameters>(Parameters{network.get_weights(), network.get_bias()});
+	for (size_t i = 0 ; i < parameters->weights.size() ; i++)
+	{
+		const Matrix<double>& weights = parameters->weights[i];
+		_layers.push_back({weights.data(), weights.getNbrLines(), weights.getNbrColumns(), weights.getStride(), parameters->bias[i].data()});
+	}
+	_storage = parameters;
+}
+
+/**
+ * @brief Use the weights and bias of a mapped binary model in place
+ *
+ * Nothing is copied, the mapping lives as long as the model and its copies.
+ */
+InferenceModel::InferenceModel(const std::shared_ptr<const ModelFile>& model)
+	: InferenceModel(model, model->layer_function(), model->output_function()) {}
+
+// same, with other activation functions than the ones saved in @param model
+InferenceModel::InferenceModel(const std::shared_ptr<const ModelFile>& model, const std::string& layer_function, const std::string& output_function)
+	: _storage(model), _topology(model->topology()),
+	_layer_activation(activation_from_name(layer_function)), _output_activation(activation_from_name(output_function))
+{
+	for (size_t i = 0 ; i < model->nbr_layers() ; i++)
+	{
+		const ModelLayer& layer = model->layer(i);
+		_layers.push_back({model->weights(i), layer.lines, layer.columns, layer.stride, model->bias(i)});
+	}
+}
+
+// run the batch in scratch._a[0] through every layer
+void	InferenceModel::forward(InferenceScratch& scratch) const
+{
+	size_t batch = scratch._a[0].getNbrColumns();
+	for (size_t i = 0 ; i < _layers.size() ; i++)
+	{
+		const InferenceLayer& layer = _layers[i];
+		Matrix<double>& z = scratch._z;
+		const Matrix<double>& a = scratch._a[i];
+		z.resize(layer.lines, batch);
+		gemm(false, false, layer.lines, batch, layer.columns, 1.0, layer.weights, layer.stride,
+			a.data(), a.getStride(), 0.0, z.data(), z.getStride());
+		for (size_t j = 0 ; j < z.getNbrLines() ; j++)
+			for (size_t k = 0 ; k < batch ; k++)
+				z(j, k) += layer.bias[j];
+		activate(i + 1 == _layers.size() ? _output_activation : _layer_activation, z, scratch._a[i + 1]);
+	}
+}
+
+/**
+ * @brief Predict @param rows examples
+ *
+ * @param inputs size_inputs() values per example, one example after the other
+ * @param rows number of examples
+ * @param outputs receives size_outputs() values per example, in the same order
+ * @param scratch buffers of the calling thread, sized to INFERENCE_BATCH if empty
+ */
+void	InferenceModel::predict(const double *inputs, const size_t& rows, double *outputs, InferenceScratch& scratch) const
+{
+	if (scratch.capacity() == 0)
+		scratch.reserve(*this, std::min<size_t>(std::max<size_t>(rows, 1), INFERENCE_BATCH));
+	if (scratch._a.size() != _topology.size() || scratch._a[0].getNbrLines() != size_inputs() || scratch._a.back().getNbrLines() != size_outputs())
+		throw Error("Error: the scratch was sized for another model");
+	for (size_t first = 0 ; first < rows ; first += scratch.capacity())
+	{
+		size_t count = std::min(scratch.capacity(), rows - first);
+		Matrix<double>& a = scratch._a[0];
+		a.resize(size_inputs(), count);
+		for (size_t k = 0 ; k < count ; k++)
+			for (size_t j = 0 ; j < size_inputs() ; j++)
+				a(j, k) = inputs[(first + k) * size_inputs() + j];
+		forward(scratch);
+		const Matrix<double>& prediction = scratch._a.back();
+		for (size_t k = 0 ; k < count ; k++)
+			for (size_t j = 0 ; j < size_outputs() ; j++)
+				outputs[(first + k) * size_outputs() + j] = prediction(j, k);
+	}
+}
+
+// predict one example
+Vector<double>	InferenceModel::predict(const Vector<double>& inputs, InferenceScratch& scratch) const
+{
+	if (inputs.dimension() != size_inputs())
+		throw Error("Error: inputs must have " + std::to_string(size_inputs()) + " values");
+	Vector<double> outputs(size_outputs());
+	predict(inputs.data(), 1, outputs.data(), scratch);
+	return outputs;
+}
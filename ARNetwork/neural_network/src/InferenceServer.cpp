@@ -0,0 +1,266 @@
+#include "../include/InferenceServer.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+// size of the reads of a connection, a request can be longer
+#define READ_BUFFER 4096
+
+Connection::~Connection(void)
+{
+	if (!_owned)
+		return ;
+	close(_input);
+	if (_output != _input)
+		close(_output);
+}
+
+// a request of the connection was queued, it has to be answered before the connection ends
+void	Connection::submitted(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pending++;
+}
+
+/**
+ * @brief Write one line, a newline is added
+ *
+ * Lines to a client which went away are dropped.
+ */
+void	Connection::write(const std::string& line)
+{
+	std::string data = line + '\n';
+	std::lock_guard<std::mutex> lock(_write);
+	for (size_t written = 0 ; written < data.size() ; )
+	{
+		ssize_t count = send(_output, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+		if (count < 0 && errno == ENOTSOCK)
+			count = ::write(_output, data.data() + written, data.size() - written);
+		if (count < 0 && errno == EINTR)
+			continue ;
+		if (count <= 0)
+			break ;
+		written += count;
+	}
+}
+
+// write the answer of a request which was submitted
+void	Connection::answer(const std::string& line)
+{
+	write(line);
+	std::lock_guard<std::mutex> lock(_mutex);
+	_pending--;
+	_answered.notify_all();
+}
+
+void	Connection::wait_answers(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_answered.wait(lock, [&] { return _pending == 0; });
+}
+
+static std::string	error_answer(const nlohmann::json& id, const std::string& message)
+{
+	return nlohmann::json({{"id", id}, {"error", message}}).dump();
+}
+
+/**
+ * @brief Start the workers
+ *
+ * @param model model every request is run through, it must outlive the server
+ * @param threads number of batches run at once
+ * @param batching how requests are grouped into batches
+ */
+InferenceServer::InferenceServer(const InferenceModel& model, const size_t& threads, const BatchingSettings& batching)
+	: _model(model), _batching(batching), _closed(false)
+{
+	if (threads == 0)
+		throw Error("Error: threads cannot be 0");
+	if (batching.max_batch == 0)
+		throw Error("Error: batch cannot be 0");
+	for (size_t i = 0 ; i < threads ; i++)
+		_workers.emplace_back(&InferenceServer::work, this);
+}
+
+InferenceServer::~InferenceServer(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closed = true;
+	}
+	_queued.notify_all();
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+void	InferenceServer::work(void)
+{
+	InferenceScratch scratch(_model, _batching.max_batch);
+	std::vector<Request> batch;
+	batch.reserve(_batching.max_batch);
+	std::vector<double> inputs(_batching.max_batch * _model.size_inputs());
+	std::vector<double> outputs(_batching.max_batch * _model.size_outputs());
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_queued.wait(lock, [&] { return _closed || !_queue.empty(); });
+			if (_queue.empty())
+				return ;
+			_queued.wait_until(lock, _queue.front().arrival + _batching.max_wait,
+				[&] { return _closed || _queue.empty() || _queue.size() >= _batching.max_batch; });
+			// another worker may have taken them while this one waited
+			if (_queue.empty())
+				continue ;
+			size_t count = std::min(_batching.max_batch, _queue.size());
+			for (size_t i = 0 ; i < count ; i++)
+			{
+				batch.push_back(std::move(_queue.front()));
+				_queue.pop_front();
+			}
+			_batch_sizes.record(count);
+		}
+		for (size_t i = 0 ; i < batch.size() ; i++)
+			std::copy(batch[i].inputs.begin(), batch[i].inputs.end(), inputs.begin() + i * _model.size_inputs());
+		try
+		{
+			_model.predict(inputs.data(), batch.size(), outputs.data(), scratch);
+			for (size_t i = 0 ; i < batch.size() ; i++)
+			{
+				auto first = outputs.begin() + i * _model.size_outputs();
+				std::vector<double> prediction(first, first + _model.size_outputs());
+				batch[i].connection->answer(nlohmann::json({{"id", batch[i].id}, {"outputs", prediction}}).dump());
+			}
+		}
+		catch (const std::exception& e)
+		{
+			for (auto& request : batch)
+				request.connection->answer(error_answer(request.id, e.what()));
+		}
+		batch.clear();
+	}
+}
+
+// histograms of the number of queued requests when one arrives, and of the size of the batches run
+void	InferenceServer::statistics(std::ostream& out)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_queue_depths.display(out, "queue depth");
+	_batch_sizes.display(out, "batch size");
+}
+
+/**
+ * @brief Parse and queue the request of the line [@param begin, @param end)
+ * of @param connection, or answer it right away with an error if it can't be run
+ */
+void	InferenceServer::read_request(const std::shared_ptr<Connection>& connection, const char *begin, const char *end)
+{
+	if (end == begin || (end == begin + 1 && *begin == '\r'))
+		return ;
+	nlohmann::json line = nlohmann::json::parse(begin, end, nullptr, false);
+	if (line.is_discarded() || !line.is_object())
+	{
+		connection->write(error_answer(nullptr, "request is not a JSON object"));
+		return ;
+	}
+	Request request = {connection, line.value("id", nlohmann::json()), {}, {}};
+	auto inputs = line.find("inputs");
+	if (inputs == line.end() || !inputs->is_array() || inputs->size() != _model.size_inputs()
+		|| !std::all_of(inputs->begin(), inputs->end(), [](const nlohmann::json& value) { return value.is_number(); }))
+	{
+		connection->write(error_answer(request.id, "inputs must be an array of " + std::to_string(_model.size_inputs()) + " numbers"));
+		return ;
+	}
+	request.inputs = inputs->get<std::vector<double>>();
+	request.arrival = std::chrono::steady_clock::now();
+	connection->submitted();
+	bool full;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_queue.push_back(std::move(request));
+		_queue_depths.record(_queue.size());
+		full = _queue.size() >= _batching.max_batch;
+	}
+	// a worker waiting to fill its batch has to hear about it
+	if (full)
+		_queued.notify_all();
+	else
+		_queued.notify_one();
+}
+
+/**
+ * @brief Parse and queue every request of @param connection until it ends
+ *
+ * The last request may miss its newline. Once the input ends, returns when
+ * every request queued was answered.
+ */
+void	InferenceServer::read_requests(const std::shared_ptr<Connection>& connection)
+{
+	std::string pending;
+	char buffer[READ_BUFFER];
+	while (true)
+	{
+		ssize_t count = read(connection->input(), buffer, sizeof(buffer));
+		if (count < 0 && errno == EINTR)
+			continue ;
+		if (count <= 0)
+			break ;
+		pending.append(buffer, count);
+		size_t begin = 0;
+		for (size_t end = pending.find('\n') ; end != std::string::npos ; begin = end + 1, end = pending.find('\n', begin))
+			read_request(connection, pending.data() + begin, pending.data() + end);
+		pending.erase(0, begin);
+	}
+	read_request(connection, pending.data(), pending.data() + pending.size());
+	connection->wait_answers();
+}
+
+/**
+ * @brief Answer the requests read from @param input on @param output until
+ * the input ends, stdin and stdout for instance
+ */
+void	InferenceServer::serve(const int& input, const int& output)
+{
+	read_requests(std::make_shared<Connection>(input, output, false));
+}
+
+/**
+ * @brief Answer the clients of a Unix domain socket, never returns
+ *
+ * Each client is read by its own thread, all of them share the workers.
+ *
+ * @param socket_path path of the socket, replaced if it exists
+ */
+void	InferenceServer::listen(const std::string& socket_path)
+{
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+		throw Error("Error: socket path is too long");
+	std::strcpy(address.sun_path, socket_path.c_str());
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0)
+		throw Error("Error: couldn't create a socket");
+	unlink(socket_path.c_str());
+	if (bind(server, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(server, SOMAXCONN) < 0)
+	{
+		close(server);
+		throw Error("Error: couldn't listen on " + socket_path);
+	}
+	while (true)
+	{
+		int client = accept(server, nullptr, nullptr);
+		if (client < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue ;
+			close(server);
+			throw Error("Error: couldn't accept a client on " + socket_path);
+		}
+		std::shared_ptr<Connection> connection = std::make_shared<Connection>(client, client, true);
+		std::thread(&InferenceServer::read_requests, this, connection).detach();
+	}
+}
@@ -1,66 +1,556 @@
 #include "../include/ARNetwork.hpp"
+#include "../include/ModelFile.hpp"
+#include "../include/AtomicFile.hpp"
+#include <charconv>
+#include <cstring>
+#include <sstream>
+#include <limits>
+
+// shortest text which reads back as the same double
+static void	write_number(AtomicFile& file, const double& number)
+{
+	if (!std::isfinite(number))
+		throw Error("Error: a json model cannot hold " + std::to_string(number));
+	char buffer[32];
+	std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+	file.write(buffer, result.ptr - buffer);
+}
+
+static void	write_numbers(AtomicFile& file, const double *numbers, const size_t& size)
+{
+	file.put('[');
+	for (size_t i = 0 ; i < size ; i++)
+	{
+		if (i)
+			file.put(',');
+		write_number(file, numbers[i]);
+	}
+	file.put(']');
+}
+
+static void	write_string(AtomicFile& file, const std::string& string)
+{
+	file.put('"');
+	for (const char& c : string)
+	{
+		if (c == '"' || c == '\\')
+			file.put('\\');
+		if (static_cast<unsigned char>(c) < 0x20)
+			throw Error("Error: a json model cannot hold the name " + string);
+		file.put(c);
+	}
+	file.put('"');
+}
+
+static void	write_key(AtomicFile& file, const char *key)
+{
+	file.put('"');
+	file.write(key, std::strlen(key));
+	file.write("\":", 2);
+}
+
+// the fields of a model, in the order of nlohmann::json::dump, between the braces of its object
+static void	write_fields(AtomicFile& file, const std::vector<Matrix<double>>& weights, const std::vector<Vector<double>>& bias,
+	const double& learning_rate, const std::string& loss_function, const std::string& layer_function, const std::string& output_function)
+{
+	write_key(file, "bias");
+	file.put('[');
+	for (size_t i = 0 ; i < bias.size() ; i++)
+	{
+		if (i)
+			file.put(',');
+		write_numbers(file, bias[i].data(), bias[i].dimension());
+	}
+	file.put(']');
+	file.put(',');
+	write_key(file, "hidden_activation");
+	write_string(file, layer_function);
+	file.put(',');
+	write_key(file, "learning_rate");
+	write_number(file, learning_rate);
+	file.put(',');
+	write_key(file, "loss");
+	write_string(file, loss_function);
+	file.put(',');
+	write_key(file, "output_activation");
+	write_string(file, output_function);
+	file.put(',');
+	write_key(file, "weights");
+	file.put('[');
+	for (size_t i = 0 ; i < weights.size() ; i++)
+	{
+		if (i)
+			file.put(',');
+		file.put('[');
+		for (size_t j = 0 ; j < weights[i].getNbrLines() ; j++)
+		{
+			if (j)
+				file.put(',');
+			write_numbers(file, &weights[i](j, 0), weights[i].getNbrColumns());
+		}
+		file.put(']');
+	}
+	file.put(']');
+}
 
 /**
  * @brief Create a json file which contains the bias, weights, loss function, layer function and output function of the neural network
- * 
+ *
+ * The numbers are written as they are formatted, with the shortest text
+ * which reads back as the same double, and keys in the order of
+ * nlohmann::json::dump. The file is replaced at once when it is complete:
+ * a crash while saving leaves the previous one.
+ *
  * @param file_name name of the json file
  */
 void	ARNetwork::get_json(const std::string& file_name) const
 {
-	nlohmann::json data;
-	data["weights"] = nlohmann::json::array();
-	for (size_t i = 0 ; i < nbr_hidden_layers() + 1 ; i++)
-	{
-		nlohmann::json matrix = nlohmann::json::array();
-		for (size_t j = 0 ; j < _weights[i].getNbrLines() ; j++)
-			matrix.push_back(_weights[i].getLine(j).getStdVector());
-		data["weights"].push_back(matrix);
-	}
-	data["bias"] = nlohmann::json::array();
-	for (size_t i = 0 ; i < nbr_hidden_layers() + 1 ; i++)
-		data["bias"].push_back(_bias[i].getStdVector());
-	data["learning_rate"] = _learning_rate;
-	data["hidden_activation"] = _layer_function;
-	data["output_activation"] = _output_function;
-	data["loss"] = _loss_function;
-	std::ofstream file(file_name);
-	if (file.is_open())
-	{
-		file << data.dump();
-		std::cout << "Log saved in " << file_name << "\n";
-		file.close();
-	}
+	AtomicFile file(file_name);
+	file.put('{');
+	write_fields(file, _weights, _bias, _learning_rate, _loss_function, _layer_function, _output_function);
+	file.put('}');
+	file.commit();
+	std::cout << "Log saved in " << file_name << "\n";
+}
+
+// a measure of the history, null when it isn't finite
+static void	write_measure(AtomicFile& file, const double& measure)
+{
+	if (std::isfinite(measure))
+		write_number(file, measure);
 	else
-		std::cerr << "Error: could't save log\n";
+		file.write("null", 4);
 }
 
-ARNetwork::ARNetwork(const std::string& file_name)
+/**
+ * @brief Write a training state as a json model with what resumes its training
+ *
+ * Besides the fields of a model: the number of epochs done, the history as
+ * one [epoch, training loss, training r2, validation loss, validation r2]
+ * array per epoch, and the state of the generator as written by its
+ * operator<<. The file loads as a model, ARNetwork(file_name) gets all of
+ * it back.
+ */
+void	write_checkpoint(const std::string& file_name, const TrainingState& state)
 {
-	std::ifstream file(file_name);
-	if (!file.is_open())
-		throw Error("Error: couldn't open " + file_name);
-	nlohmann::json data;
-	try { file >> data; }
-	catch (const nlohmann::json::parse_error& e) { std::cout << e.what() << "\n"; }
-	_inputs = Vector<double>(data["weights"][0][0].size());
-	_outputs = Vector<double>(data["weights"][data["weights"].size() - 1].size());
-	_weights = std::vector<Matrix<double>>(data["weights"].size());
-	_bias = std::vector<Vector<double>>(data["bias"].size());
-	_z = std::vector<Vector<double>>(data["weights"].size());
-	_a = std::vector<Vector<double>>(data["weights"].size());
-	_learning_rate = data["learning_rate"];
-	for (size_t layer = 0 ; layer < data["weights"].size() ; layer++)
-	{
-		_weights[layer] = Matrix<double>(data["weights"][layer].size(), data["weights"][layer][0].size());
-		_bias[layer] = Vector<double>(data["bias"][layer].size());
-	}
-	for (size_t layer = 0 ; layer < data["weights"].size() ; layer++)
-	{
-		for (size_t row = 0 ; row < data["weights"][layer].size() ; row++)
+	AtomicFile file(file_name);
+	file.put('{');
+	write_fields(file, state.weights, state.bias, state.learning_rate, state.loss_function, state.layer_function, state.output_function);
+	file.put(',');
+	write_key(file, "epoch");
+	std::string epoch = std::to_string(state.epoch);
+	file.write(epoch.data(), epoch.size());
+	file.put(',');
+	write_key(file, "history");
+	file.put('[');
+	for (const auto& training : state.history.first)
+	{
+		if (training.first != state.history.first.begin()->first)
+			file.put(',');
+		std::pair<double, double> validation = state.history.second.at(training.first);
+		std::string index = "[" + std::to_string(training.first);
+		file.write(index.data(), index.size());
+		for (const double& measure : {training.second.first, training.second.second, validation.first, validation.second})
+		{
+			file.put(',');
+			write_measure(file, measure);
+		}
+		file.put(']');
+	}
+	file.put(']');
+	file.put(',');
+	write_key(file, "urng");
+	std::ostringstream urng;
+	urng << state.urng;
+	write_string(file, urng.str());
+	file.put('}');
+	file.commit();
+}
+
+/*
+ * The model is read with the SAX interface of nlohmann::json: no document
+ * is built, every number goes straight where it belongs. When the bias come
+ * before the weights, as get_json writes them, each weight matrix is
+ * allocated once with its final shape before its first number is read.
+ * Otherwise its lines grow as they come. Shapes are checked while reading.
+ * Only the model and the read buffer of the file are in memory.
+ */
+
+namespace
+{
+	enum class	Field
+	{
+		None,
+		Weights,
+		Bias,
+		LearningRate,
+		Loss,
+		Hidden,
+		Output,
+		Epoch,
+		History,
+		Urng,
+		Unknown	// skipped
+	};
+
+	class	ModelReader
+	{
+		public:
+			using number_integer_t = nlohmann::json::number_integer_t;
+			using number_unsigned_t = nlohmann::json::number_unsigned_t;
+			using number_float_t = nlohmann::json::number_float_t;
+			using string_t = nlohmann::json::string_t;
+			using binary_t = nlohmann::json::binary_t;
+
+			std::vector<Matrix<double>>		weights;
+			std::vector<std::vector<double>>	bias;
+			double					learning_rate;
+			size_t					epoch;
+			TrainingHistory				history;
+			bool					has_urng;
+			std::mt19937				urng;
+			std::string				loss;
+			std::string				hidden;
+			std::string				output;
+
+		private:
+			const std::string&			_file_name;
+			Field					_field;
+			size_t					_depth;
+			size_t					_row;
+			size_t					_column;
+			size_t					_columns;	// 0 while the first line of the first layer is read
+			bool					_sized;		// lines given by the bias
+			std::vector<double>			_first_line;
+			double					_entry[5];	// epoch of the history being read, and its measures
+			size_t					_entry_size;
+			unsigned				_seen;
+
+			[[noreturn]] void			fail(const std::string& what) const { throw Error("Error: " + _file_name + " is corrupted: " + what); }
+			std::string				where(void) const;
+			void					value(const double& number);
+			void					scalar(const char *type);
+			void					grow(void);
+			void					end_line(void);
+			void					end_layer(void);
+			void					end_entry(void);
+
+		public:
+								ModelReader(const std::string& file_name) : learning_rate(0), epoch(0), has_urng(false), loss("bce"), hidden("sigmoid"), output("softmax"),
+								_file_name(file_name), _field(Field::None), _depth(0), _row(0), _column(0), _columns(0), _sized(false), _entry(), _entry_size(0), _seen(0) {}
+
+			void					check(void) const;
+
+			bool					null(void);
+			bool					boolean(bool) { scalar("boolean"); return true; }
+			bool					number_integer(number_integer_t number);
+			bool					number_unsigned(number_unsigned_t number);
+			bool					number_float(number_float_t number, const string_t&) { value(number); return true; }
+			bool					string(string_t& string);
+			bool					binary(binary_t&) { scalar("binary"); return true; }
+			bool					start_object(size_t);
+			bool					key(string_t& key);
+			bool					end_object(void) { _depth--; return true; }
+			bool					start_array(size_t);
+			bool					end_array(void);
+			bool					parse_error(size_t, const std::string&, const nlohmann::detail::exception& e)
+								{ throw Error("Error: " + _file_name + " is not valid json: " + e.what()); }
+	};
+
+	// the place being read, like weights[1][3]
+	std::string	ModelReader::where(void) const
+	{
+		if (_field == Field::Weights && _depth >= 3)
+			return "weights[" + std::to_string(weights.size() - 1) + "][" + std::to_string(_row) + "]";
+		if (_field == Field::Weights && _depth == 2)
+			return "weights[" + std::to_string(weights.size()) + "]";
+		if (_field == Field::Bias && _depth >= 2)
+			return "bias[" + std::to_string(bias.size() - (_depth >= 3)) + "]";
+		if (_field == Field::Weights)
+			return "weights";
+		if (_field == Field::Bias)
+			return "bias";
+		if (_field == Field::LearningRate)
+			return "learning_rate";
+		if (_field == Field::Epoch)
+			return "epoch";
+		if (_field == Field::History && _depth >= 2)
+			return "history[" + std::to_string(history.first.size()) + "]";
+		if (_field == Field::History)
+			return "history";
+		return "the model";
+	}
+
+	void	ModelReader::scalar(const char *type)
+	{
+		if (_field != Field::Unknown)
+			fail("unexpected " + std::string(type) + " in " + where());
+	}
+
+	void	ModelReader::value(const double& number)
+	{
+		if (_field == Field::Weights && _depth == 4)
+		{
+			Matrix<double>& layer = weights.back();
+			if (_columns == 0)
+				_first_line.push_back(number);
+			else if (_column == _columns)
+				fail(where() + " has more than " + std::to_string(_columns) + " values");
+			else
+				layer(_row, _column++) = number;
+		}
+		else if (_field == Field::Bias && _depth == 3)
+		{
+			std::vector<double>& layer = bias.back();
+			if (bias.size() <= weights.size() && layer.size() == weights[bias.size() - 1].getNbrLines())
+				fail(where() + " has more values than weights[" + std::to_string(bias.size() - 1) + "] has lines");
+			layer.push_back(number);
+		}
+		else if (_field == Field::History && _depth == 3)
 		{
-			_bias[layer][row] = data["bias"][layer][row];
-			for (size_t col = 0 ; col < data["weights"][layer][row].size() ; col++)
-				_weights[layer][row][col] = data["weights"][layer][row][col];
+			if (_entry_size == 5)
+				fail(where() + " has more than 5 values");
+			_entry[_entry_size++] = number;
 		}
+		else if (_field == Field::LearningRate && _depth == 1)
+			learning_rate = number;
+		else
+			scalar("number");
 	}
-}
\ No newline at end of file
+
+	// a measure of the history which wasn't finite
+	bool	ModelReader::null(void)
+	{
+		if (_field == Field::History && _depth == 3 && _entry_size > 0)
+			value(std::numeric_limits<double>::quiet_NaN());
+		else
+			scalar("null");
+		return true;
+	}
+
+	bool	ModelReader::number_integer(number_integer_t number)
+	{
+		if (_field == Field::Epoch && _depth == 1)
+			fail("epoch must be a positive integer");
+		value(number);
+		return true;
+	}
+
+	bool	ModelReader::number_unsigned(number_unsigned_t number)
+	{
+		if (_field == Field::Epoch && _depth == 1)
+			epoch = number;
+		else
+			value(number);
+		return true;
+	}
+
+	bool	ModelReader::string(string_t& string)
+	{
+		if (_depth == 1 && _field == Field::Loss)
+			loss = string;
+		else if (_depth == 1 && _field == Field::Hidden)
+			hidden = string;
+		else if (_depth == 1 && _field == Field::Output)
+			output = string;
+		else if (_depth == 1 && _field == Field::Urng)
+		{
+			std::istringstream in(string);
+			in >> urng;
+			if (in.fail() || !(in >> std::ws).eof())
+				fail("urng is not the state of a std::mt19937");
+			has_urng = true;
+		}
+		else
+			scalar("string");
+		return true;
+	}
+
+	bool	ModelReader::start_object(size_t)
+	{
+		if (_depth != 0 && _field != Field::Unknown)
+			fail("unexpected object in " + where());
+		_depth++;
+		return true;
+	}
+
+	bool	ModelReader::key(string_t& key)
+	{
+		if (_depth != 1)
+			return true;
+		static const std::pair<const char *, Field> fields[] = {{"weights", Field::Weights}, {"bias", Field::Bias},
+			{"learning_rate", Field::LearningRate}, {"loss", Field::Loss}, {"hidden_activation", Field::Hidden}, {"output_activation", Field::Output},
+			{"epoch", Field::Epoch}, {"history", Field::History}, {"urng", Field::Urng}};
+		_field = Field::Unknown;
+		for (size_t i = 0 ; i < sizeof(fields) / sizeof(*fields) ; i++)
+		{
+			if (key != fields[i].first)
+				continue ;
+			if (_seen & (1u << i))
+				fail(key + " is given twice");
+			_seen |= 1u << i;
+			_field = fields[i].second;
+		}
+		return true;
+	}
+
+	bool	ModelReader::start_array(size_t)
+	{
+		if (_depth == 0)
+			fail("the model must be a json object");
+		if (_field == Field::Weights && _depth == 2)
+		{
+			// a new layer, allocated now if its shape is known
+			size_t index = weights.size();
+			weights.emplace_back();
+			_row = 0;
+			_columns = index ? weights[index - 1].getNbrLines() : 0;
+			_sized = index < bias.size();
+			if (_sized && _columns)
+				weights.back().resize(bias[index].size(), _columns);
+		}
+		else if (_field == Field::Weights && _depth == 3)
+		{
+			_column = 0;
+			if (_columns && _row == weights.back().getNbrLines())
+				grow();
+		}
+		else if (_field == Field::History && _depth == 2)
+			_entry_size = 0;
+		else if (_field == Field::Bias && _depth == 2)
+		{
+			bias.emplace_back();
+			if (bias.size() <= weights.size())
+				bias.back().reserve(weights[bias.size() - 1].getNbrLines());
+		}
+		else if (_field != Field::Unknown && !((_field == Field::Weights || _field == Field::Bias || _field == Field::History) && _depth == 1))
+			fail("unexpected array in " + where());
+		_depth++;
+		return true;
+	}
+
+	// room for one more line in the current layer of weights
+	void	ModelReader::grow(void)
+	{
+		if (_sized)
+			fail(where() + " is beyond the " + std::to_string(bias[weights.size() - 1].size()) + " values of bias[" + std::to_string(weights.size() - 1) + "]");
+		Matrix<double>& layer = weights.back();
+		Matrix<double> grown(std::max<size_t>(2 * layer.getNbrLines(), 16), _columns);
+		std::copy(layer.data(), layer.data() + layer.getNbrLines() * layer.getStride(), grown.data());
+		layer = std::move(grown);
+	}
+
+	void	ModelReader::end_line(void)
+	{
+		if (_columns == 0)
+		{
+			// the first line gives the number of inputs
+			if (_first_line.empty())
+				fail(where() + " is empty");
+			_columns = _first_line.size();
+			weights.back().resize(_sized ? bias[0].size() : 16, _columns);
+			std::copy(_first_line.begin(), _first_line.end(), &weights.back()(0, 0));
+			std::vector<double>().swap(_first_line);
+		}
+		else if (_column != _columns)
+			fail(where() + " has " + std::to_string(_column) + " values instead of " + std::to_string(_columns));
+		_row++;
+	}
+
+	void	ModelReader::end_layer(void)
+	{
+		size_t index = weights.size() - 1;
+		if (_row == 0)
+			fail("weights[" + std::to_string(index) + "] is empty");
+		if (_sized && _row != bias[index].size())
+			fail("weights[" + std::to_string(index) + "] has " + std::to_string(_row) + " lines instead of the " + std::to_string(bias[index].size()) + " values of bias[" + std::to_string(index) + "]");
+		if (_row != weights.back().getNbrLines())
+		{
+			Matrix<double> layer(_row, _columns);
+			std::copy(weights.back().data(), weights.back().data() + _row * layer.getStride(), layer.data());
+			weights.back() = std::move(layer);
+		}
+	}
+
+	void	ModelReader::end_entry(void)
+	{
+		if (_entry_size != 5)
+			fail(where() + " has " + std::to_string(_entry_size) + " values instead of 5");
+		if (!(_entry[0] >= 0) || _entry[0] != std::floor(_entry[0]))
+			fail(where() + " doesn't start with an epoch");
+		size_t index = _entry[0];
+		if (history.first.count(index))
+			fail(where() + " gives epoch " + std::to_string(index) + " twice");
+		history.first[index] = {_entry[1], _entry[2]};
+		history.second[index] = {_entry[3], _entry[4]};
+	}
+
+	bool	ModelReader::end_array(void)
+	{
+		_depth--;
+		if (_field == Field::Weights && _depth == 3)
+			end_line();
+		else if (_field == Field::Weights && _depth == 2)
+			end_layer();
+		else if (_field == Field::History && _depth == 2)
+			end_entry();
+		else if (_field == Field::Bias && _depth == 2 && bias.back().empty())
+			fail("bias[" + std::to_string(bias.size() - 1) + "] is empty");
+		return true;
+	}
+
+	// what can only be checked once everything was read
+	void	ModelReader::check(void) const
+	{
+		if (!(_seen & 1u) || weights.empty())
+			fail("weights are missing");
+		if (!(_seen & 2u) || bias.size() != weights.size())
+			fail("there are " + std::to_string(bias.size()) + " layers of bias for " + std::to_string(weights.size()) + " layers of weights");
+		if (!(_seen & 4u))
+			fail("learning_rate is missing");
+		for (size_t i = 0 ; i < weights.size() ; i++)
+			if (bias[i].size() != weights[i].getNbrLines())
+				fail("bias[" + std::to_string(i) + "] has " + std::to_string(bias[i].size()) + " values for " + std::to_string(weights[i].getNbrLines()) + " lines of weights");
+	}
+}
+
+/**
+ * @brief Load a network saved by get_json, write_checkpoint or write_model
+ *
+ * A checkpoint also gives back the epochs done, their history, and the
+ * state of the generator of its training, kept in the network: after
+ * restore_urng() its training goes on as if it never stopped. Until then
+ * the network draws from global_urng(), which loading leaves untouched.
+ *
+ * @param file_name json file, or binary model file recognized by its magic
+ */
+ARNetwork::ARNetwork(const std::string& file_name)
+{
+	if (is_model_file(file_name))
+	{
+		load(ModelFile(file_name));
+		return ;
+	}
+	std::ifstream file(file_name, std::ios::binary);
+	if (!file.is_open())
+		throw Error("Error: couldn't open " + file_name);
+	ModelReader reader(file_name);
+	nlohmann::json::sax_parse(file, &reader);
+	reader.check();
+	_inputs = Vector<double>(reader.weights.front().getNbrColumns());
+	_outputs = Vector<double>(reader.weights.back().getNbrLines());
+	_weights = std::move(reader.weights);
+	_bias = std::vector<Vector<double>>(reader.bias.begin(), reader.bias.end());
+	_z = std::vector<Vector<double>>(_weights.size());
+	_a = std::vector<Vector<double>>(_weights.size());
+	_learning_rate = reader.learning_rate;
+	_steady_state_allocations = 0;
+	_epoch = reader.epoch;
+	_history = std::move(reader.history);
+	_checkpoint = {"", 0, 0};
+	_shuffle = true;
+	_urng = &global_urng();
+	_saved_urng = reader.urng;
+	_has_saved_urng = reader.has_urng;
+	set_functions(reader.loss, reader.hidden, reader.output);
+}
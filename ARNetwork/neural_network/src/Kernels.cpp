@@ -0,0 +1,281 @@
+#include "../include/Kernels.hpp"
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+/*
+ * exp(x) = 2^k * exp(r) with k = round(x / ln 2) and |r| <= ln 2 / 2.
+ * ln 2 is split in a high and a low part so r is exact, and exp(r) - 1 is
+ * a degree 13 Taylor polynomial whose truncation error stays under
+ * 1e-18 on that interval. Keeping exp(r) - 1 apart lets tanh compute
+ * exp(x) - 1 without cancellation for small x.
+ * 2^k is applied as two factors, so results below the normal range round
+ * to subnormals then 0, and results above it overflow to inf, as std::exp.
+ */
+
+#define LOG2E	1.4426950408889634074
+#define LN2_HI	6.93147180369123816490e-01
+#define LN2_LO	1.90821492927058770002e-10
+#define EXP_MIN	-746.0	// exp rounds to 0 from -745.14
+#define EXP_MAX	710.0	// and to inf from 709.79
+
+typedef void	(*kernel_type)(const double *, double *, const size_t&);
+
+static const double	taylor[] = {
+	1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0,
+	1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 1.0 / 2.0, 1.0
+};
+
+void	exp_scalar(const double *x, double *y, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		y[i] = std::exp(x[i]);
+}
+
+void	sigmoid_scalar(const double *z, double *a, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		a[i] = 1 / (1 + std::exp(-z[i]));
+}
+
+void	tanh_scalar(const double *z, double *a, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		a[i] = std::tanh(z[i]);
+}
+
+void	relu_scalar(const double *z, double *a, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		a[i] = z[i] <= 0 ? 0 : z[i];
+}
+
+void	leaky_relu_scalar(const double *z, double *a, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		a[i] = z[i] <= 0 ? z[i] * 0.01 : z[i];
+}
+
+// q = exp(r) - 1 and k for x = k * ln 2 + r, x already clamped
+__attribute__((target("avx2,fma")))
+static inline __m256d	expm1_reduced(const __m256d& x, __m256d& k)
+{
+	k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	__m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_HI), x);
+	r = _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_LO), r);
+	__m256d p = _mm256_set1_pd(taylor[0]);
+	for (size_t i = 1 ; i < sizeof(taylor) / sizeof(*taylor) ; i++)
+		p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(taylor[i]));
+	return _mm256_mul_pd(p, r);
+}
+
+// 2^k for integral k in [-1022, 1023]
+__attribute__((target("avx2,fma")))
+static inline __m256d	pow2(const __m256d& k)
+{
+	__m256i e = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+	e = _mm256_slli_epi64(_mm256_add_epi64(e, _mm256_set1_epi64x(1023)), 52);
+	return _mm256_castsi256_pd(e);
+}
+
+// max/min take the NaN from their second operand, so NaN goes through
+__attribute__((target("avx2,fma")))
+static inline __m256d	clamp(const __m256d& x, const double& min, const double& max)
+{
+	return _mm256_min_pd(_mm256_set1_pd(max), _mm256_max_pd(_mm256_set1_pd(min), x));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d	exp4(const __m256d& x)
+{
+	__m256d k;
+	__m256d q = expm1_reduced(clamp(x, EXP_MIN, EXP_MAX), k);
+	__m256d half = _mm256_floor_pd(_mm256_mul_pd(k, _mm256_set1_pd(0.5)));
+	__m256d y = _mm256_mul_pd(pow2(half), _mm256_add_pd(q, _mm256_set1_pd(1.0)));
+	return _mm256_mul_pd(y, pow2(_mm256_sub_pd(k, half)));
+}
+
+__attribute__((target("avx2,fma")))
+static void	exp_avx2(const double *x, double *y, const size_t& n)
+{
+	size_t i = 0;
+	for ( ; i + 4 <= n ; i += 4)
+		_mm256_storeu_pd(y + i, exp4(_mm256_loadu_pd(x + i)));
+	if (i < n)
+	{
+		double tail[4] = {0, 0, 0, 0};
+		std::memcpy(tail, x + i, (n - i) * sizeof(double));
+		_mm256_storeu_pd(tail, exp4(_mm256_loadu_pd(tail)));
+		std::memcpy(y + i, tail, (n - i) * sizeof(double));
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d	sigmoid4(const __m256d& z)
+{
+	__m256d one = _mm256_set1_pd(1.0);
+	__m256d e = exp4(_mm256_sub_pd(_mm256_setzero_pd(), z));
+	return _mm256_div_pd(one, _mm256_add_pd(one, e));
+}
+
+// tanh(|z|) = e / (e + 2) with e = exp(2 |z|) - 1, sign put back afterwards
+__attribute__((target("avx2,fma")))
+static inline __m256d	tanh4(const __m256d& z)
+{
+	__m256d sign = _mm256_set1_pd(-0.0);
+	__m256d y = clamp(_mm256_add_pd(_mm256_andnot_pd(sign, z), _mm256_andnot_pd(sign, z)), 0.0, 40.0);
+	__m256d k;
+	__m256d q = expm1_reduced(y, k);
+	__m256d scale = pow2(k);
+	__m256d e = _mm256_fmadd_pd(scale, q, _mm256_sub_pd(scale, _mm256_set1_pd(1.0)));
+	__m256d t = _mm256_div_pd(e, _mm256_add_pd(e, _mm256_set1_pd(2.0)));
+	return _mm256_or_pd(t, _mm256_and_pd(sign, z));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d	relu4(const __m256d& z, const double& slope)
+{
+	__m256d positive = _mm256_cmp_pd(z, _mm256_setzero_pd(), _CMP_GT_OQ);
+	return _mm256_blendv_pd(_mm256_mul_pd(z, _mm256_set1_pd(slope)), z, positive);
+}
+
+__attribute__((target("avx2,fma")))
+static void	sigmoid_avx2(const double *z, double *a, const size_t& n)
+{
+	size_t i = 0;
+	for ( ; i + 4 <= n ; i += 4)
+		_mm256_storeu_pd(a + i, sigmoid4(_mm256_loadu_pd(z + i)));
+	for ( ; i < n ; i++)
+	{
+		double tail[4] = {z[i], 0, 0, 0};
+		_mm256_storeu_pd(tail, sigmoid4(_mm256_loadu_pd(tail)));
+		a[i] = tail[0];
+	}
+}
+
+__attribute__((target("avx2,fma")))
+static void	tanh_avx2(const double *z, double *a, const size_t& n)
+{
+	size_t i = 0;
+	for ( ; i + 4 <= n ; i += 4)
+		_mm256_storeu_pd(a + i, tanh4(_mm256_loadu_pd(z + i)));
+	for ( ; i < n ; i++)
+	{
+		double tail[4] = {z[i], 0, 0, 0};
+		_mm256_storeu_pd(tail, tanh4(_mm256_loadu_pd(tail)));
+		a[i] = tail[0];
+	}
+}
+
+// relu4 with a slope of 0 gives -0.0 for negative z, the scalar loop gives 0;
+// the mask is true for NaN, which goes through as in the scalar loop
+__attribute__((target("avx2,fma")))
+static void	relu_avx2(const double *z, double *a, const size_t& n)
+{
+	__m256d zero = _mm256_setzero_pd();
+	size_t i = 0;
+	for ( ; i + 4 <= n ; i += 4)
+	{
+		__m256d x = _mm256_loadu_pd(z + i);
+		_mm256_storeu_pd(a + i, _mm256_and_pd(x, _mm256_cmp_pd(x, zero, _CMP_NLE_UQ)));
+	}
+	relu_scalar(z + i, a + i, n - i);
+}
+
+__attribute__((target("avx2,fma")))
+static void	leaky_relu_avx2(const double *z, double *a, const size_t& n)
+{
+	size_t i = 0;
+	for ( ; i + 4 <= n ; i += 4)
+		_mm256_storeu_pd(a + i, relu4(_mm256_loadu_pd(z + i), 0.01));
+	leaky_relu_scalar(z + i, a + i, n - i);
+}
+
+static bool	has_avx2(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+
+static kernel_type	pick(const kernel_type& avx2, const kernel_type& scalar)
+{
+	static const bool avx2_supported = has_avx2();
+	return avx2_supported ? avx2 : scalar;
+}
+
+void	exp_kernel(const double *x, double *y, const size_t& n)
+{
+	static const kernel_type kernel = pick(exp_avx2, exp_scalar);
+	kernel(x, y, n);
+}
+
+void	sigmoid_kernel(const double *z, double *a, const size_t& n)
+{
+	static const kernel_type kernel = pick(sigmoid_avx2, sigmoid_scalar);
+	kernel(z, a, n);
+}
+
+void	tanh_kernel(const double *z, double *a, const size_t& n)
+{
+	static const kernel_type kernel = pick(tanh_avx2, tanh_scalar);
+	kernel(z, a, n);
+}
+
+void	relu_kernel(const double *z, double *a, const size_t& n)
+{
+	static const kernel_type kernel = pick(relu_avx2, relu_scalar);
+	kernel(z, a, n);
+}
+
+void	leaky_relu_kernel(const double *z, double *a, const size_t& n)
+{
+	static const kernel_type kernel = pick(leaky_relu_avx2, leaky_relu_scalar);
+	kernel(z, a, n);
+}
+
+void	identity_kernel(const double *z, double *a, const size_t& n)
+{
+	if (z != a)
+		std::memmove(a, z, n * sizeof(double));
+}
+
+/*
+ * Plain loops: no transcendental left, the compiler vectorizes them and
+ * they are bound by memory anyway
+ */
+
+void	sigmoid_derive_output_kernel(const double *a, double *d, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		d[i] = a[i] * (1.0 - a[i]);
+}
+
+void	tanh_derive_output_kernel(const double *a, double *d, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		d[i] = 1.0 - a[i] * a[i];
+}
+
+void	relu_derive_output_kernel(const double *a, double *d, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		d[i] = a[i] <= 0 ? 0.0 : 1.0;
+}
+
+// a and z have the same sign for a slope of 0.01
+void	leaky_relu_derive_output_kernel(const double *a, double *d, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		d[i] = a[i] <= 0 ? 0.01 : 1.0;
+}
+
+void	identity_derive_output_kernel(const double *a, double *d, const size_t& n)
+{
+	for (size_t i = 0 ; i < n ; i++)
+		d[i] = a[i] >= 0 ? 1.0 : -1.0;
+}
+
+const char	*activation_kernel_name(void)
+{
+	return pick(exp_avx2, exp_scalar) == exp_avx2 ? "avx2" : "scalar";
+}
@@ -0,0 +1,37 @@
+#include "../include/MappedFile.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& file_name) : _data(nullptr), _size(0)
+{
+	int fd = open(file_name.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw Error("Error: couldn't open " + file_name);
+	struct stat info;
+	if (fstat(fd, &info) < 0)
+	{
+		close(fd);
+		throw Error("Error: couldn't read " + file_name);
+	}
+	_size = info.st_size;
+	if (_size)
+	{
+		void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			close(fd);
+			throw Error("Error: couldn't map " + file_name);
+		}
+		madvise(data, _size, MADV_SEQUENTIAL);
+		_data = static_cast<const char *>(data);
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile(void)
+{
+	if (_data)
+		munmap(const_cast<char *>(_data), _size);
+}
@@ -0,0 +1,197 @@
+#include "../include/ModelFile.hpp"
+#include "../include/ARNetwork.hpp"
+#include "../include/AtomicFile.hpp"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+static size_t	align_block(const size_t& offset)
+{
+	return (offset + MODEL_ALIGNMENT - 1) / MODEL_ALIGNMENT * MODEL_ALIGNMENT;
+}
+
+// hash @param size bytes, a multiple of 8, into @param hash
+static void	checksum(uint64_t& hash, const char *data, const size_t& size)
+{
+	for (size_t i = 0 ; i < size ; i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = (hash ^ word) * FNV_PRIME;
+	}
+}
+
+static void	copy_name(char (&name)[MODEL_NAME_SIZE], const std::string& function)
+{
+	if (function.size() >= MODEL_NAME_SIZE)
+		throw Error("Error: function name too long: " + function);
+	std::memcpy(name, function.c_str(), function.size() + 1);
+}
+
+// a block of the payload, followed by 0 up to the next 64 bytes boundary
+struct	Block
+{
+	const char	*data;
+	size_t		size;
+};
+
+/**
+ * @brief Write the weights, bias and functions of a network as a binary model file
+ *
+ * The file is replaced at once when it is complete.
+ *
+ * @param file_name path of the file
+ * @param network model to write
+ */
+void	write_model(const std::string& file_name, const ARNetwork& network)
+{
+	const std::vector<Matrix<double>>& weights = network.get_weights();
+	const std::vector<Vector<double>>& bias = network.get_bias();
+	ModelHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+	header.version = MODEL_VERSION;
+	header.nbr_layers = weights.size();
+	header.learning_rate = network.get_learning_rate();
+	copy_name(header.loss, network.get_loss_function());
+	copy_name(header.hidden_activation, network.get_layer_function());
+	copy_name(header.output_activation, network.get_output_function());
+	std::vector<ModelLayer> layers(weights.size());
+	size_t offset = sizeof(ModelHeader) + align_block(layers.size() * sizeof(ModelLayer));
+	for (size_t i = 0 ; i < weights.size() ; i++)
+	{
+		layers[i] = {weights[i].getNbrLines(), weights[i].getNbrColumns(), weights[i].getStride(), offset, 0};
+		offset += align_block(weights[i].getNbrLines() * weights[i].getStride() * sizeof(double));
+		layers[i].bias = offset;
+		offset += align_block(bias[i].dimension() * sizeof(double));
+	}
+	header.payload_size = offset - sizeof(ModelHeader);
+	std::vector<Block> blocks(1, {reinterpret_cast<const char *>(layers.data()), layers.size() * sizeof(ModelLayer)});
+	for (size_t i = 0 ; i < weights.size() ; i++)
+	{
+		blocks.push_back({reinterpret_cast<const char *>(weights[i].data()), layers[i].lines * layers[i].stride * sizeof(double)});
+		blocks.push_back({reinterpret_cast<const char *>(bias[i].data()), bias[i].dimension() * sizeof(double)});
+	}
+	// the checksum goes in the header, before the blocks it covers
+	const char padding[MODEL_ALIGNMENT] = {};
+	header.checksum = FNV_OFFSET;
+	for (const auto& block : blocks)
+	{
+		checksum(header.checksum, block.data, block.size);
+		checksum(header.checksum, padding, align_block(block.size) - block.size);
+	}
+	AtomicFile file(file_name);
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	for (const auto& block : blocks)
+	{
+		file.write(block.data, block.size);
+		file.write(padding, align_block(block.size) - block.size);
+	}
+	file.commit();
+	std::cout << "Log saved in " << file_name << "\n";
+}
+
+// @return true if @param file_name starts like a binary model file
+bool	is_model_file(const std::string& file_name)
+{
+	std::ifstream file(file_name, std::ios::binary);
+	char magic[8];
+	if (!file.read(magic, sizeof(magic)))
+		return false;
+	return std::memcmp(magic, MODEL_MAGIC, sizeof(magic)) == 0;
+}
+
+static bool	valid_name(const char (&name)[MODEL_NAME_SIZE])
+{
+	return std::memchr(name, '\0', MODEL_NAME_SIZE) != nullptr;
+}
+
+/**
+ * @brief Map a binary model file
+ *
+ * @param file_name path of a file written by write_model
+ * @param verify check the checksum, which reads the whole file
+ */
+ModelFile::ModelFile(const std::string& file_name, const bool& verify) : _file(file_name)
+{
+	if (_file.size() < sizeof(ModelHeader))
+		throw Error("Error: " + file_name + " is not a binary model");
+	std::memcpy(&_header, _file.data(), sizeof(ModelHeader));
+	if (std::memcmp(_header.magic, MODEL_MAGIC, sizeof(_header.magic)) != 0)
+		throw Error("Error: " + file_name + " is not a binary model");
+	if (_header.version != MODEL_VERSION)
+		throw Error("Error: " + file_name + " has an unknown version: " + std::to_string(_header.version));
+	if (_header.payload_size != _file.size() - sizeof(ModelHeader))
+		throw Error("Error: " + file_name + " is truncated");
+	if (!valid_name(_header.loss) || !valid_name(_header.hidden_activation) || !valid_name(_header.output_activation))
+		throw Error("Error: " + file_name + " is corrupted: wrong function name");
+	if (_header.nbr_layers == 0 || _header.nbr_layers > _header.payload_size / sizeof(ModelLayer))
+		throw Error("Error: " + file_name + " is corrupted: wrong number of layers");
+	_layers.resize(_header.nbr_layers);
+	std::memcpy(_layers.data(), _file.data() + sizeof(ModelHeader), _layers.size() * sizeof(ModelLayer));
+	for (size_t i = 0 ; i < _layers.size() ; i++)
+	{
+		const ModelLayer& layer = _layers[i];
+		std::string name = file_name + " is corrupted: layer " + std::to_string(i);
+		if (layer.lines == 0 || layer.columns == 0 || layer.stride < layer.columns || (i && layer.columns != _layers[i - 1].lines))
+			throw Error("Error: " + name + " has a wrong shape");
+		if (layer.weights % MODEL_ALIGNMENT || layer.bias % MODEL_ALIGNMENT)
+			throw Error("Error: " + name + " is not aligned");
+		if (layer.stride > _file.size() / sizeof(double) || layer.lines > _file.size() / sizeof(double) / layer.stride
+			|| layer.weights > _file.size() || layer.lines * layer.stride * sizeof(double) > _file.size() - layer.weights
+			|| layer.bias > _file.size() || layer.lines * sizeof(double) > _file.size() - layer.bias)
+			throw Error("Error: " + name + " is out of the file");
+	}
+	if (!verify)
+		return ;
+	uint64_t hash = FNV_OFFSET;
+	checksum(hash, _file.data() + sizeof(ModelHeader), _header.payload_size / 8 * 8);
+	if (_header.payload_size % 8 || hash != _header.checksum)
+		throw Error("Error: " + file_name + " is corrupted: wrong checksum");
+}
+
+// number of neurals of each layer, inputs first
+std::vector<size_t>	ModelFile::topology(void) const
+{
+	std::vector<size_t> topology(1, _layers.front().columns);
+	for (const auto& layer : _layers)
+		topology.push_back(layer.lines);
+	return topology;
+}
+
+/**
+ * @brief Copy the weights, bias and functions of a binary model into the network
+ */
+void	ARNetwork::load(const ModelFile& model)
+{
+	std::vector<size_t> topology = model.topology();
+	_inputs = Vector<double>(topology.front());
+	_outputs = Vector<double>(topology.back());
+	_weights = std::vector<Matrix<double>>(model.nbr_layers());
+	_bias = std::vector<Vector<double>>(model.nbr_layers());
+	_z = std::vector<Vector<double>>(model.nbr_layers());
+	_a = std::vector<Vector<double>>(model.nbr_layers());
+	_learning_rate = model.learning_rate();
+	_steady_state_allocations = 0;
+	_epoch = 0;
+	_history = model_measures_type();
+	_checkpoint = {"", 0, 0};
+	_shuffle = true;
+	_urng = &global_urng();
+	_has_saved_urng = false;
+	set_functions(model.loss_function(), model.layer_function(), model.output_function());
+	for (size_t layer = 0 ; layer < model.nbr_layers() ; layer++)
+	{
+		const ModelLayer& shape = model.layer(layer);
+		_weights[layer] = Matrix<double>(shape.lines, shape.columns);
+		_bias[layer] = Vector<double>(shape.lines);
+		for (size_t row = 0 ; row < shape.lines ; row++)
+		{
+			std::memcpy(&_weights[layer](row, 0), model.weights(layer) + row * shape.stride, shape.columns * sizeof(double));
+			_bias[layer][row] = model.bias(layer)[row];
+		}
+	}
+}
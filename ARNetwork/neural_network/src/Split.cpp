@@ -0,0 +1,173 @@
+#include "../include/Split.hpp"
+#include <numeric>
+#include <cmath>
+
+// the last label is y for both a single label and a one-hot pair
+static bool	is_malignant(const DatasetView& datas, const size_t& row)
+{
+	return datas.labels(row)[datas.nbr_labels() - 1] >= 0.5;
+}
+
+// shuffled row indices, in one group or one group per class
+static std::vector<std::vector<size_t>>	shuffled_groups(const DatasetView& datas, const bool& stratify, std::mt19937& urng)
+{
+	std::vector<std::vector<size_t>> groups(stratify ? 2 : 1);
+	if (!stratify)
+	{
+		groups[0].resize(datas.size());
+		std::iota(groups[0].begin(), groups[0].end(), 0);
+	}
+	else
+		for (size_t row = 0 ; row < datas.size() ; row++)
+			groups[is_malignant(datas, row)].push_back(row);
+	for (auto& group : groups)
+		shuffle_order(group, urng);
+	return groups;
+}
+
+/**
+ * @brief Draw a training and a validation set
+ *
+ * @param datas examples to split
+ * @param training_ratio part of the examples which go to training, in [0, 1]
+ * @param stratify keep the proportion of M and B examples in both sets
+ * @param urng source of the permutation
+ *
+ * @return the rows of each set, in random order
+ */
+SplitIndices	split_indices(const DatasetView& datas, const double& training_ratio, const bool& stratify, std::mt19937& urng)
+{
+	if (!(training_ratio >= 0 && training_ratio <= 1))
+		throw Error("Error: training percentage must be between 0 and 100");
+	SplitIndices split;
+	for (const auto& group : shuffled_groups(datas, stratify, urng))
+	{
+		size_t training = static_cast<size_t>(static_cast<double>(group.size()) * training_ratio);
+		split.training.insert(split.training.end(), group.begin(), group.begin() + training);
+		split.validation.insert(split.validation.end(), group.begin() + training, group.end());
+	}
+	// the classes were appended one after the other
+	if (stratify)
+	{
+		shuffle_order(split.training, urng);
+		shuffle_order(split.validation, urng);
+	}
+	return split;
+}
+
+/**
+ * @brief Cut the examples into @param folds folds of nearly the same size
+ *
+ * Split i validates on fold i and trains on every other fold, so each
+ * example is validated exactly once.
+ *
+ * @return one split per fold
+ */
+std::vector<SplitIndices>	kfold_indices(const DatasetView& datas, const size_t& folds, const bool& stratify, std::mt19937& urng)
+{
+	if (folds < 2 || folds > datas.size())
+		throw Error("Error: folds must be between 2 and the number of examples");
+	std::vector<std::vector<size_t>> fold_rows(folds);
+	size_t dealt = 0;
+	// dealing the shuffled classes in turn spreads them evenly over the folds
+	for (const auto& group : shuffled_groups(datas, stratify, urng))
+		for (const size_t& row : group)
+			fold_rows[dealt++ % folds].push_back(row);
+	std::vector<SplitIndices> splits(folds);
+	for (size_t i = 0 ; i < folds ; i++)
+	{
+		splits[i].validation = fold_rows[i];
+		splits[i].training.reserve(datas.size() - fold_rows[i].size());
+		for (size_t j = 0 ; j < folds ; j++)
+			if (j != i)
+				splits[i].training.insert(splits[i].training.end(), fold_rows[j].begin(), fold_rows[j].end());
+		if (stratify)
+			shuffle_order(splits[i].validation, urng);
+		shuffle_order(splits[i].training, urng);
+	}
+	return splits;
+}
+
+/**
+ * @brief Scale the raw features of data.csv
+ *
+ * In each column, zeros (missing measures) are replaced by the mean of the
+ * column, then every value is divided by the maximum of the column.
+ */
+void	normalize_features(Dataset& datas)
+{
+	size_t nbr_line = datas.size();
+	size_t nbr_columns = datas.nbr_features();
+	std::vector<double> mean_coefs(nbr_columns, 0);
+	std::vector<double> max_coef(nbr_columns, 0);
+	for (size_t line = 0 ; line < nbr_line ; line++)
+	{
+		const double *features = datas.features(line);
+		for (size_t col = 0 ; col < nbr_columns ; col++)
+		{
+			mean_coefs[col] += features[col];
+			max_coef[col] = features[col] > max_coef[col] ? features[col] : max_coef[col];
+		}
+	}
+	for (auto& coef : mean_coefs)
+		coef /= nbr_line;
+	for (size_t line = 0 ; line < nbr_line ; line++)
+	{
+		double *features = datas.features(line);
+		for (size_t i = 0 ; i < nbr_columns ; i++)
+		{
+			features[i] = features[i] == 0 ? mean_coefs[i] : features[i];
+			features[i] /= max_coef[i];
+		}
+	}
+}
+
+// copy of the examples @param rows of @param datas, in that order
+Dataset	select_rows(const DatasetView& datas, const std::vector<size_t>& rows)
+{
+	Dataset selection(datas.nbr_features(), datas.nbr_labels());
+	selection.reserve(rows.size());
+	for (const size_t& row : rows)
+	{
+		if (row >= datas.size())
+			throw Error("Error: index out of range");
+		selection.push_back(datas.features(row), datas.labels(row));
+	}
+	return selection;
+}
+
+/**
+ * @brief Topology of a network for data.csv: 30 inputs, the hidden layers
+ * of @param arg, which are sizes separated by spaces, then 2 outputs
+ */
+std::vector<size_t>	get_network(const std::string& arg)
+{
+	std::vector<size_t> layers;
+	layers.push_back(30);
+	for (size_t i = 0 ; i < arg.size() ; i++)
+	{
+		if (!isdigit(arg[i]) && arg[i] != ' ')
+			throw Error("Error: wrong format of layer");
+		if (isdigit(arg[i]))
+		{
+			layers.push_back(std::atoi(arg.c_str() + i));
+			for ( ; i < arg.size() ; i++)
+				if (arg[i] == ' ')
+					break;
+		}
+	}
+	layers.push_back(2);
+	return layers;
+}
+
+// value @param arg of the flag @param flag, a positive integer which is null only if @param zero
+size_t	positive_integer(const std::string& flag, const char *arg, const bool& zero)
+{
+	const std::string error = "Error: " + flag + (zero ? " must be a positive integer" : " must be a non null positive integer");
+	int value;
+	try { value = std::stoi(arg); }
+	catch (...) { throw Error(error); }
+	if (value < (zero ? 0 : 1))
+		throw Error(error);
+	return value;
+}
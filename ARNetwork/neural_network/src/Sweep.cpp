@@ -0,0 +1,113 @@
+#include "../include/Sweep.hpp"
+
+// every combination of the values given
+std::vector<TrialConfig>	grid_configs(const std::vector<std::vector<size_t>>& layers, const std::vector<double>& learning_rates,
+	const std::vector<size_t>& batches, const std::vector<std::string>& layer_functions)
+{
+	std::vector<TrialConfig> configs;
+	for (const auto& network : layers)
+		for (const double& learning_rate : learning_rates)
+			for (const size_t& batch : batches)
+				for (const std::string& layer_function : layer_functions)
+					configs.push_back({network, learning_rate, batch, layer_function});
+	return configs;
+}
+
+/**
+ * @brief Draw @param count configurations
+ *
+ * Layers, batch and layer function are picked among the values given, the
+ * learning rate is drawn log-uniformly between the smallest and the
+ * biggest of @param learning_rates.
+ */
+std::vector<TrialConfig>	random_configs(const std::vector<std::vector<size_t>>& layers, const std::vector<double>& learning_rates,
+	const std::vector<size_t>& batches, const std::vector<std::string>& layer_functions, const size_t& count, std::mt19937& urng)
+{
+	if (layers.empty() || learning_rates.empty() || batches.empty() || layer_functions.empty())
+		throw Error("Error: every hyperparameter needs at least one value");
+	auto pick = [&](const size_t& size) { return std::uniform_int_distribution<size_t>(0, size - 1)(urng); };
+	auto bounds = std::minmax_element(learning_rates.begin(), learning_rates.end());
+	std::uniform_real_distribution<double> exponent(std::log(*bounds.first), std::log(*bounds.second));
+	std::vector<TrialConfig> configs;
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		TrialConfig config;
+		config.layers = layers[pick(layers.size())];
+		config.learning_rate = *bounds.first == *bounds.second ? *bounds.first : std::exp(exponent(urng));
+		config.batch = batches[pick(batches.size())];
+		config.layer_function = layer_functions[pick(layer_functions.size())];
+		configs.push_back(config);
+	}
+	return configs;
+}
+
+// a diverged trial ranks after every other one
+static double	rank_loss(const TrialResult& result)
+{
+	return std::isnan(result.loss) ? INFINITY : result.loss;
+}
+
+/**
+ * @brief Train every configuration and rank them by successive halving
+ *
+ * The trials of a rung run concurrently on a WorkStealingPool, each one
+ * single-threaded on its own network, all reading @param datas through the
+ * rows of @param split. After each rung only the best trials by validation
+ * loss keep training, the others are cancelled with their last measures.
+ * Networks and shuffling generators are all drawn from global_urng() before
+ * the first rung, so a seeded sweep doesn't depend on the number of threads.
+ *
+ * @return one result per configuration, best first: the trials which
+ * trained the longest come first, then by validation loss
+ */
+std::vector<TrialResult>	sweep(const std::vector<TrialConfig>& configs, const DatasetView& datas, const SplitIndices& split, const SweepSettings& settings)
+{
+	if (configs.empty())
+		throw Error("Error: the sweep has no trial");
+	if (settings.min_epochs == 0 || settings.max_epochs < settings.min_epochs || settings.eta < 2)
+		throw Error("Error: epochs must go from a non null minimum to a greater maximum, with eta of 2 at least");
+	std::vector<ARNetwork> networks;
+	std::vector<std::mt19937> urngs;
+	std::vector<TrialResult> results;
+	for (const auto& config : configs)
+	{
+		if (config.layers.size() < 2 || config.layers.front() != datas.nbr_features() || config.layers.back() != datas.nbr_labels())
+			throw Error("Error: layers must go from the features to the labels of the examples");
+		networks.emplace_back(config.layers);
+		networks.back().set_learning_rate(config.learning_rate);
+		urngs.emplace_back(global_urng()());
+		results.push_back({config, 0, NAN, NAN, false});
+	}
+	for (size_t i = 0 ; i < networks.size() ; i++)
+		networks[i].set_urng(urngs[i]);
+	std::vector<size_t> alive(configs.size());
+	std::iota(alive.begin(), alive.end(), 0);
+	WorkStealingPool pool(settings.threads);
+	for (size_t budget = settings.min_epochs ; ; budget = std::min(budget * settings.eta, settings.max_epochs))
+	{
+		auto trial = [&](const size_t& i)
+		{
+			TrialResult& result = results[alive[i]];
+			auto tracking = networks[alive[i]].train("bce", result.config.layer_function, "softmax",
+				datas, split.training, split.validation, result.config.batch, budget - result.epochs);
+			result.epochs = budget;
+			result.loss = tracking.second.rbegin()->second.first;
+			result.r2 = tracking.second.rbegin()->second.second;
+		};
+		pool.run(alive.size(), trial);
+		if (budget == settings.max_epochs)
+			break ;
+		std::stable_sort(alive.begin(), alive.end(), [&](const size_t& a, const size_t& b) { return rank_loss(results[a]) < rank_loss(results[b]); });
+		size_t kept = std::max<size_t>(1, alive.size() / settings.eta);
+		for (size_t i = kept ; i < alive.size() ; i++)
+			results[alive[i]].stopped = true;
+		alive.resize(kept);
+	}
+	std::stable_sort(results.begin(), results.end(), [](const TrialResult& a, const TrialResult& b)
+	{
+		if (a.epochs != b.epochs)
+			return a.epochs > b.epochs;
+		return rank_loss(a) < rank_loss(b);
+	});
+	return results;
+}
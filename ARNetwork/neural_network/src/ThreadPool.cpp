@@ -0,0 +1,80 @@
+#include "../include/ThreadPool.hpp"
+
+/**
+ * @brief Start the workers of the pool
+ *
+ * @param threads number of threads working on a job, the caller included
+ */
+ThreadPool::ThreadPool(const size_t& threads) : _task(nullptr), _context(nullptr), _count(0), _next(0), _running(0), _generation(0), _stop(false)
+{
+	if (threads == 0)
+		throw Error("Error: threads cannot be 0");
+	_workers.reserve(threads - 1);
+	for (size_t i = 1 ; i < threads ; i++)
+		_workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+// take indices of the current job until there is none left
+void	ThreadPool::execute(void)
+{
+	for (size_t index = _next.fetch_add(1) ; index < _count ; index = _next.fetch_add(1))
+	{
+		try { _task(_context, index); }
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_error)
+				_error = std::current_exception();
+		}
+	}
+}
+
+void	ThreadPool::work(void)
+{
+	size_t generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&] { return _stop || _generation != generation; });
+			if (_stop)
+				return ;
+			generation = _generation;
+		}
+		execute();
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_running == 0)
+			_done.notify_one();
+	}
+}
+
+void	ThreadPool::dispatch(const task_type& task, void *context, const size_t& count)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_task = task;
+		_context = context;
+		_count = count;
+		_next = 0;
+		_running = _workers.size();
+		_error = nullptr;
+		_generation++;
+	}
+	_wake.notify_all();
+	execute();
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [&] { return _running == 0; });
+	if (_error)
+		std::rethrow_exception(_error);
+}
@@ -0,0 +1,74 @@
+#include "../include/WorkStealingPool.hpp"
+
+/**
+ * @brief Start the workers of the pool
+ *
+ * @param threads number of threads working on a job, the caller included
+ */
+WorkStealingPool::WorkStealingPool(const size_t& threads)
+	: _pool(threads), _task(nullptr), _context(nullptr), _steals(0)
+{
+	for (size_t i = 0 ; i < threads ; i++)
+		_queues.push_back(std::make_unique<Queue>());
+}
+
+// next index of the own queue of @param self, else one stolen from the back of another queue
+bool	WorkStealingPool::take(const size_t& self, size_t& index)
+{
+	{
+		std::lock_guard<std::mutex> lock(_queues[self]->mutex);
+		if (!_queues[self]->tasks.empty())
+		{
+			index = _queues[self]->tasks.front();
+			_queues[self]->tasks.pop_front();
+			return true;
+		}
+	}
+	for (size_t i = 1 ; i < _queues.size() ; i++)
+	{
+		Queue& victim = *_queues[(self + i) % _queues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			index = victim.tasks.back();
+			victim.tasks.pop_back();
+			_steals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+// a queue is only filled by dispatch, so once every queue is empty the job has no index left
+void	WorkStealingPool::execute(const size_t& self)
+{
+	size_t index;
+	while (take(self, index))
+	{
+		try { _task(_context, index); }
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_error)
+				_error = std::current_exception();
+		}
+	}
+}
+
+void	WorkStealingPool::dispatch(const task_type& task, void *context, const size_t& count)
+{
+	for (size_t t = 0 ; t < _queues.size() ; t++)
+	{
+		std::lock_guard<std::mutex> lock(_queues[t]->mutex);
+		for (size_t i = t * count / _queues.size() ; i < (t + 1) * count / _queues.size() ; i++)
+			_queues[t]->tasks.push_back(i);
+	}
+	_task = task;
+	_context = context;
+	_error = nullptr;
+	// the thread running index t of the pool empties queue t, then steals
+	auto drain = [this](const size_t& self) { execute(self); };
+	_pool.run(_queues.size(), drain);
+	if (_error)
+		std::rethrow_exception(_error);
+}
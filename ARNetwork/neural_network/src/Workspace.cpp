@@ -0,0 +1,43 @@
+#include "../include/Workspace.hpp"
+
+/**
+ * @brief Allocate every buffer for batches of up to @param batch examples
+ * 
+ * @param topology number of neurals of each layer, inputs and outputs included
+ * @param batch biggest number of examples which will go through the network at once
+ */
+void	Workspace::reserve(const std::vector<size_t>& topology, const size_t& batch)
+{
+	if (topology.size() < 2)
+		throw Error("Error: not enough layers in the topology");
+	if (batch == 0)
+		throw Error("Error: batch cannot be 0");
+	size_t layers = topology.size() - 1;
+	size_t widest = *std::max_element(topology.begin(), topology.end());
+	_z = std::vector<Matrix<double>>(layers);
+	_a = std::vector<Matrix<double>>(layers + 1);
+	_dW = std::vector<Matrix<double>>(layers);
+	_dZ = std::vector<Matrix<double>>(layers);
+	for (size_t l = 0 ; l < layers ; l++)
+	{
+		_z[l].resize(topology[l + 1], batch);
+		_a[l].resize(topology[l], batch);
+		_dW[l].resize(topology[l + 1], topology[l]);
+		_dZ[l].resize(topology[l + 1], 1);
+	}
+	_a[layers].resize(topology[layers], batch);
+	_y.resize(topology[layers], batch);
+	_delta.resize(widest, batch);
+	_derivative.resize(widest, batch);
+	_dA.resize(widest, batch);
+	_capacity = batch;
+}
+
+void	Workspace::reset_gradients(void)
+{
+	for (size_t l = 0 ; l < _dW.size() ; l++)
+	{
+		std::fill(_dW[l].data(), _dW[l].data() + _dW[l].getNbrLines() * _dW[l].getStride(), 0.0);
+		std::fill(_dZ[l].data(), _dZ[l].data() + _dZ[l].getNbrLines() * _dZ[l].getStride(), 0.0);
+	}
+}
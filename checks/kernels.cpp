@@ -0,0 +1,111 @@
+#include "../ARNetwork/neural_network/include/Kernels.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+/*
+ * Compare every activation kernel picked for this CPU with its scalar
+ * reference, on random inputs, on the tails and on +-0, +-inf and NaN,
+ * against the bounds of Kernels.hpp. Exits with 1 if one is exceeded.
+ */
+
+typedef void	(*kernel_type)(const double *, double *, const size_t&);
+
+struct	Check
+{
+	const char	*name;
+	kernel_type	kernel;
+	kernel_type	reference;
+	double		range;		// random inputs are drawn in [-range, range]
+	uint64_t	bound;		// ulp
+};
+
+// doubles in the order of the integers, so the difference counts the doubles between two values
+static int64_t	ordered(const double& x)
+{
+	int64_t i;
+	std::memcpy(&i, &x, sizeof(i));
+	return i < 0 ? std::numeric_limits<int64_t>::min() - i : i;
+}
+
+static uint64_t	ulp(const double& x, const double& y)
+{
+	if (std::isnan(x) || std::isnan(y))
+		return std::isnan(x) && std::isnan(y) ? 0 : std::numeric_limits<uint64_t>::max();
+	int64_t a = ordered(x);
+	int64_t b = ordered(y);
+	return a > b ? static_cast<uint64_t>(a) - static_cast<uint64_t>(b) : static_cast<uint64_t>(b) - static_cast<uint64_t>(a);
+}
+
+static std::vector<double>	inputs(const double& range)
+{
+	const double inf = std::numeric_limits<double>::infinity();
+	std::vector<double> x = {0.0, -0.0, inf, -inf, std::numeric_limits<double>::quiet_NaN(),
+		std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min(),
+		std::numeric_limits<double>::min(), -std::numeric_limits<double>::min(), 1e-300, -1e-300, 1e-20, -1e-20,
+		708, -708, 709, -709, 709.78, 709.79, 710, -710, -744, -745, -745.13, -745.14, 746, -746, 1e300, -1e300};
+	// the tails, where exp leaves the normal range
+	for (double t = 700 ; t <= 712 ; t += 1.0 / 1024)
+	{
+		x.push_back(t);
+		x.push_back(-t);
+	}
+	for (double t = 730 ; t <= 750 ; t += 1.0 / 1024)
+		x.push_back(-t);
+	std::mt19937 urng(42);
+	std::uniform_real_distribution<double> uniform(-range, range);
+	std::uniform_real_distribution<double> exponent(-30, 3);
+	for (size_t i = 0 ; i < 1000000 ; i++)
+		x.push_back(uniform(urng));
+	// small magnitudes, where tanh and exp - 1 cancel
+	for (size_t i = 0 ; i < 200000 ; i++)
+		x.push_back((i % 2 ? -1 : 1) * std::pow(10.0, exponent(urng)));
+	return x;
+}
+
+int	main(void)
+{
+	std::vector<Check> checks = {
+		{"exp", exp_kernel, exp_scalar, 750, 1},
+		{"sigmoid", sigmoid_kernel, sigmoid_scalar, 750, 4},
+		{"tanh", tanh_kernel, tanh_scalar, 30, 4},
+		{"relu", relu_kernel, relu_scalar, 100, 0},
+		{"leakyrelu", leaky_relu_kernel, leaky_relu_scalar, 100, 0}};
+	bool failed = false;
+	std::cout.precision(17);
+	std::cout << "kernels: " << activation_kernel_name() << std::endl;
+	for (const auto& check : checks)
+	{
+		std::vector<double> x = inputs(check.range);
+		std::vector<double> y(x.size());
+		std::vector<double> expected(x.size());
+		check.kernel(x.data(), y.data(), x.size());
+		check.reference(x.data(), expected.data(), x.size());
+		uint64_t worst = 0;
+		size_t at = 0;
+		for (size_t i = 0 ; i < x.size() ; i++)
+		{
+			// 1 more ulp for subnormal results, rounded twice
+			uint64_t error = ulp(y[i], expected[i]);
+			if (std::fpclassify(expected[i]) == FP_SUBNORMAL && error > 0)
+				error--;
+			if (error > worst)
+			{
+				worst = error;
+				at = i;
+			}
+		}
+		std::cout << check.name << ": " << worst << " ulp at most, bound " << check.bound;
+		if (worst > check.bound)
+		{
+			std::cout << " FAILED for " << x[at] << ": " << y[at] << " instead of " << expected[at];
+			failed = true;
+		}
+		std::cout << std::endl;
+	}
+	return failed;
+}
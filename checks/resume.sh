@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Train 10 epochs at once, then 5 epochs checkpointed and resumed up to 10,
+# in memory, on 2 threads and streamed by chunks. The resumed training has
+# to print the same history and save the same model, byte for byte.
+# Needs ./train, and training.csv and validation.csv from ./split.
+
+root=$(pwd)
+if [ ! -f training.csv ] || [ ! -f validation.csv ] ; then
+	echo "resume: training.csv and validation.csv are missing, run ./split first"
+	exit 1
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+ln -s "$root/training.csv" "$root/validation.csv" "$work"
+cd "$work" || exit 1
+
+failed=0
+for mode in "" "--threads 2" "--chunk 64" ; do
+	"$root/train" --layer '24 24' --epoch 10 --batch 8 --seed 1 $mode > once.out || exit 1
+	mv model.json once.json
+	"$root/train" --layer '24 24' --epoch 5 --batch 8 --seed 1 $mode --checkpoint 5 > /dev/null || exit 1
+	"$root/train" --resume checkpoint.json --epoch 10 --batch 8 $mode > resumed.out || exit 1
+	rm -f checkpoint.json
+	if cmp -s once.out resumed.out && cmp -s once.json model.json ; then
+		echo "resume${mode:+ $mode}: identical"
+	else
+		echo "resume${mode:+ $mode}: FAILED, the resumed training differs"
+		failed=1
+	fi
+done
+exit $failed
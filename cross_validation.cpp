@@ -0,0 +1,70 @@
+#include "ARNetwork/neural_network/include/CrossValidation.hpp"
+#include "ARNetwork/neural_network/include/Csv.hpp"
+
+#define USAGE "Error: ./cross_validation --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch> --folds <folds> --threads <threads> --seed <seed> --stratify]"
+
+int	main(int argc, char **argv)
+{
+	try
+	{
+		std::vector<size_t> network;
+		std::string layer_function = "sigmoid";
+		double learning_rate = 0.1;
+		size_t epoch = 1000;
+		size_t batch = 1;
+		size_t folds = 5;
+		size_t threads = std::max(1u, std::thread::hardware_concurrency());
+		bool stratify = false;
+		for (int i = 1 ; i < argc ; i++)
+		{
+			std::string flag = argv[i];
+			if (flag == "--stratify")
+				stratify = true;
+			else if (i + 1 >= argc)
+				throw Error(USAGE);
+			else if (flag == "--layer")
+				network = get_network(argv[++i]);
+			else if (flag == "--layer_function")
+				layer_function = argv[++i];
+			else if (flag == "--learning_rate")
+			{
+				try { learning_rate = std::stod(argv[++i]); }
+				catch (...) { throw Error("Error: learning rate must be a non null positive double"); }
+				if (learning_rate <= 0)
+					throw Error("Error: learning rate must be a non null positive double");
+			}
+			else if (flag == "--epoch")
+				epoch = positive_integer("epoch", argv[++i]);
+			else if (flag == "--batch")
+				batch = positive_integer("batch", argv[++i]);
+			else if (flag == "--folds")
+				folds = positive_integer("folds", argv[++i]);
+			else if (flag == "--threads")
+				threads = positive_integer("threads", argv[++i]);
+			else if (flag == "--seed")
+			{
+				unsigned long value;
+				try { value = std::stoul(argv[++i]); }
+				catch (...) { throw Error("Error: seed must be a positive integer"); }
+				seed_urng(value);
+			}
+			else
+				throw Error("Error: unknown flag: " + flag);
+		}
+		if (network.empty())
+			throw Error(USAGE);
+		Dataset datas = read_csv("data.csv", {1, 30, true, 0});
+		normalize_features(datas);
+		ARNetwork arn(network);
+		arn.set_learning_rate(learning_rate);
+		arn.set_functions("bce", layer_function, "softmax");
+		std::vector<SplitIndices> splits = kfold_indices(datas, folds, stratify, global_urng());
+		CrossValidationReport report = cross_validate(arn, datas, splits, batch, epoch, threads);
+		for (size_t i = 0 ; i < report.folds.size() ; i++)
+			std::cout << "fold " << i << " loss = " << report.folds[i].validation.first << " r2 = " << report.folds[i].validation.second << std::endl;
+		std::cout << "loss mean = " << report.loss_mean << " variance = " << report.loss_variance << std::endl;
+		std::cout << "r2 mean = " << report.r2_mean << " variance = " << report.r2_variance << std::endl;
+	}
+	catch (const std::exception& e) { std::cerr << e.what() << std::endl; }
+	return 0;
+}
@@ -1,18 +1,252 @@
-#include "ARNetwork/neural_network/include/ARNetwork.hpp"
+#include "ARNetwork/neural_network/include/InferenceServer.hpp"
+#include "ARNetwork/neural_network/include/BinaryDataset.hpp"
+#include "ARNetwork/neural_network/include/Csv.hpp"
+#include "ARNetwork/neural_network/include/Split.hpp"
+#include <charconv>
+#include <chrono>
+#include <unistd.h>
+
+#define USAGE "Error: ./prediction <file.json|file.bin> <layer_function> [30 datas]\n       ./prediction <file.json|file.bin> <layer_function> --input <file.csv|file.bin> [--output <file> --skip <columns> --unlabeled --batch <batch>]\n       ./prediction <file.json|file.bin> <layer_function> --serve [--socket <path> --threads <threads> --max_batch <batch> --max_wait <microseconds> --stats <seconds>]"
+
+// size from which the predictions are written to the output
+#define WRITE_BUFFER (1 << 16)
+
+// examples read at once from the input, in batches
+#define CHUNK_BATCHES 64
+
+struct	BatchOptions
+{
+	std::string	input;
+	std::string	output;
+	size_t		skip;
+	bool		labeled;
+	size_t		batch;
+};
+
+static BatchOptions	parse_batch_args(int argc, char **argv)
+{
+	BatchOptions options = {"", "", 0, true, INFERENCE_BATCH};
+	for (int i = 3 ; i < argc ; i++)
+	{
+		std::string flag = argv[i];
+		if (flag == "--unlabeled")
+			options.labeled = false;
+		else if (i + 1 >= argc)
+			throw Error(USAGE);
+		else if (flag == "--input")
+			options.input = argv[++i];
+		else if (flag == "--output")
+			options.output = argv[++i];
+		else if (flag == "--skip")
+			options.skip = positive_integer("skip", argv[++i], true);
+		else if (flag == "--batch")
+			options.batch = positive_integer("batch", argv[++i]);
+		else
+			throw Error("Error: unknown flag: " + flag);
+	}
+	if (options.input.empty())
+		throw Error(USAGE);
+	return options;
+}
+
+/**
+ * @brief Answer requests until stdin ends, or forever on a socket
+ *
+ * The queue depth and batch size histograms go to stderr every --stats
+ * seconds, and when stdin ends.
+ */
+static void	serve(const InferenceModel& model, int argc, char **argv)
+{
+	std::string socket_path;
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
+	BatchingSettings batching = {64, std::chrono::microseconds(0)};
+	size_t period = 0;
+	for (int i = 4 ; i < argc ; i += 2)
+	{
+		std::string flag = argv[i];
+		if (i + 1 >= argc)
+			throw Error(USAGE);
+		else if (flag == "--socket")
+			socket_path = argv[i + 1];
+		else if (flag == "--threads")
+			threads = positive_integer("threads", argv[i + 1]);
+		else if (flag == "--max_batch")
+			batching.max_batch = positive_integer("max_batch", argv[i + 1]);
+		else if (flag == "--max_wait")
+			batching.max_wait = std::chrono::microseconds(positive_integer("max_wait", argv[i + 1], true));
+		else if (flag == "--stats")
+			period = positive_integer("stats", argv[i + 1]);
+		else
+			throw Error("Error: unknown flag: " + flag);
+	}
+	InferenceServer server(model, threads, batching);
+	std::mutex mutex;
+	std::condition_variable stopped;
+	bool stop = false;
+	std::thread reporter([&]
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (period && !stopped.wait_for(lock, std::chrono::seconds(period), [&] { return stop; }))
+			server.statistics(std::cerr);
+	});
+	try
+	{
+		if (socket_path.empty())
+			server.serve(STDIN_FILENO, STDOUT_FILENO);
+		else
+			server.listen(socket_path);
+	}
+	catch (...)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		stopped.notify_all();
+		reporter.join();
+		throw ;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	stopped.notify_all();
+	reporter.join();
+	server.statistics(std::cerr);
+}
+
+static double	seconds_since(const std::chrono::steady_clock::time_point& start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Predict every example of @param source and write one line of
+ * comma separated outputs per example to @param out
+ *
+ * The source is read ahead on a background thread while the previous chunk
+ * goes through the model, @param batch examples per GEMM. Progress, then
+ * throughput and the accuracy when the examples have labels, go to stderr.
+ */
+static void	predict_stream(const InferenceModel& model, IDataSource& source, std::ostream& out, const size_t& batch, const bool& labeled)
+{
+	if (source.nbr_features() != model.size_inputs())
+		throw Error("Error: examples must have " + std::to_string(model.size_inputs()) + " inputs");
+	ChunkReader reader(batch * CHUNK_BATCHES, 2);
+	InferenceScratch scratch(model, batch);
+	std::vector<double> outputs(batch * CHUNK_BATCHES * model.size_outputs());
+	std::string buffer;
+	buffer.reserve(WRITE_BUFFER + 1024);
+	char number[32];
+	size_t rows = 0;
+	size_t correct = 0;
+	auto start = std::chrono::steady_clock::now();
+	double reported = 0;
+	reader.start(source);
+	while (const Dataset *chunk = reader.next())
+	{
+		model.predict(chunk->features(), chunk->size(), outputs.data(), scratch);
+		for (size_t row = 0 ; row < chunk->size() ; row++)
+		{
+			const double *prediction = outputs.data() + row * model.size_outputs();
+			for (size_t j = 0 ; j < model.size_outputs() ; j++)
+			{
+				if (j)
+					buffer += ',';
+				buffer.append(number, std::to_chars(number, number + sizeof(number), prediction[j]).ptr);
+			}
+			buffer += '\n';
+			if (buffer.size() >= WRITE_BUFFER)
+			{
+				out.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+			// the last label is y for a single label and a one-hot pair
+			bool malignant = prediction[model.size_outputs() - 1] >= prediction[0];
+			correct += malignant == (chunk->labels(row)[chunk->nbr_labels() - 1] >= 0.5);
+		}
+		rows += chunk->size();
+		if (seconds_since(start) - reported >= 1)
+		{
+			reported = seconds_since(start);
+			std::cerr << rows << " examples, " << static_cast<size_t>(rows / reported) << " examples/s" << std::endl;
+		}
+	}
+	out.write(buffer.data(), buffer.size());
+	out.flush();
+	double elapsed = seconds_since(start);
+	std::cerr << rows << " examples predicted in " << elapsed << " s (" << static_cast<size_t>(elapsed > 0 ? rows / elapsed : 0) << " examples/s)" << std::endl;
+	if (labeled && rows)
+		std::cerr << "accuracy = " << static_cast<double>(correct) / static_cast<double>(rows) << std::endl;
+}
+
+static void	predict_file(const InferenceModel& model, const BatchOptions& options, std::ostream& out)
+{
+	if (options.input.size() >= 4 && options.input.compare(options.input.size() - 4, 4, ".bin") == 0)
+	{
+		// a binary dataset holds only features and labels, the labels of every example
+		if (options.skip)
+			throw Error("Error: --skip is only for csv inputs, " + options.input + " has no column to skip");
+		BinarySource source(options.input);
+		if (!options.labeled && source.nbr_labels())
+			throw Error("Error: --unlabeled is only for inputs without labels, " + options.input + " has some");
+		predict_stream(model, source, out, options.batch, options.labeled);
+		return ;
+	}
+	CsvFormat format = {options.skip, model.size_inputs(), false, 0};
+	format.labeled = options.labeled;
+	CsvSource source(options.input, format);
+	predict_stream(model, source, out, options.batch, options.labeled);
+}
+
+// a binary model is used in place from its mapped pages, a json one is parsed
+static InferenceModel	load_model(const std::string& file_name, const std::string& layer_function)
+{
+	if (is_model_file(file_name))
+		return InferenceModel(std::make_shared<const ModelFile>(file_name), layer_function, "softmax");
+	ARNetwork arn(file_name);
+	arn.set_functions(arn.get_loss_function(), layer_function, "softmax");
+	return InferenceModel(arn);
+}
 
 int	main(int argc, char **argv)
 {
 	try
 	{
+		if (argc >= 4 && std::string(argv[3]) == "--serve")
+		{
+			serve(load_model(argv[1], argv[2]), argc, argv);
+			return 0;
+		}
+		if (argc >= 4 && std::string(argv[3]).compare(0, 2, "--") == 0)
+		{
+			// the model is loaded once for every example of the input
+			BatchOptions options = parse_batch_args(argc, argv);
+			InferenceModel model = load_model(argv[1], argv[2]);
+			if (options.output.empty())
+			{
+				std::ios::sync_with_stdio(false);
+				predict_file(model, options, std::cout);
+				return 0;
+			}
+			std::ofstream out(options.output, std::ios::binary);
+			if (!out)
+				throw Error("Error: couldn't open " + options.output);
+			predict_file(model, options, out);
+			if (!out)
+				throw Error("Error: couldn't write " + options.output);
+			return 0;
+		}
 		if (argc != 33)
-			throw Error("Error: ./prediction <file.json> <layer_function> [30 datas]");
+			throw Error(USAGE);
 		Vector<double> inputs(30);
 		for (size_t i = 0 ; i < 30 ; i++)
 			inputs[i] = std::atof(argv[i + 3]);
-		ARNetwork arn(argv[1]);
-		Vector<double> outputs = arn.feed_forward(inputs, argv[2], "softmax");
+		InferenceModel model = load_model(argv[1], argv[2]);
+		InferenceScratch scratch(model, 1);
+		Vector<double> outputs = model.predict(inputs, scratch);
 		outputs.display();
 	}
 	catch (const std::exception& e) { std::cerr << e.what() << std::endl; }
 	return 0;
-}
\ No newline at end of file
+}
@@ -1,154 +1,131 @@
 #include "ARNetwork/neural_network/include/ARNetwork.hpp"
+#include "ARNetwork/neural_network/include/Csv.hpp"
+#include "ARNetwork/neural_network/include/BinaryDataset.hpp"
+#include "ARNetwork/neural_network/include/Split.hpp"
+#include <charconv>
 
-static void	read_line(const std::string& line, std::vector<double>& data)
-{
-	bool comma = false;
-	for (size_t i = 0 ; line[i] ; i++)
-	{
-		if (line[i] == ',')
-			comma = true;
-		if (isalpha(line[i]) && comma && line[i - 1] == ',')
-			data.push_back(line[i] == 'M' ? 1 : 0);
-		else if (comma && line[i - 1] == ',')
-			data.push_back(std::atof(line.c_str() + i));
-	}
-}
+#define USAGE "Error: ./split <training_percentage> [--stratify --seed <seed> --binary <float64|float32>]\n       ./split --folds <folds> [--stratify --seed <seed> --binary <float64|float32>]"
+
+// size from which the output buffer of write_csv is written to the file
+#define WRITE_BUFFER (1 << 20)
 
-static void	valid_line(const std::string& line, const size_t& comma, const size_t& dot, const std::string& file, const size_t& index)
+// the label then the features of each row, with 6 significant digits
+static void	write_csv(const std::string& file_name, const Dataset& datas, const std::vector<size_t>& rows)
 {
-	size_t count_dot = 0;
-	size_t count_comma = 0;
-	for (size_t i = 0 ; i < line.size() ; i++)
+	std::ofstream file(file_name, std::ios::binary);
+	if (!file)
+		throw Error("Error: couldn't open " + file_name);
+	std::string buffer;
+	buffer.reserve(WRITE_BUFFER + 1024);
+	char number[32];
+	for (const size_t& row : rows)
 	{
-		if (!isdigit(line[i]) && line[i] != ',' && line[i] != '.' && line[i] != 'M' && line[i] != 'B')
-			throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-		if (line[i] == ',')
+		buffer += *datas.labels(row) ? '1' : '0';
+		for (size_t i = 0 ; i < datas.nbr_features() ; i++)
 		{
-			count_comma++;
-			if (i == 0)
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-			if ((!isdigit(line[i - 1]) && line[i - 1] != 'M' && line[i - 1] != 'B') || (!isdigit(line[i + 1]) && line[i + 1] != 'M' && line[i + 1] != 'B'))
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
+			buffer += ',';
+			std::to_chars_result result = std::to_chars(number, number + sizeof(number), datas.features(row)[i], std::chars_format::general, 6);
+			buffer.append(number, result.ptr);
 		}
-		if (line[i] == '.')
+		buffer += '\n';
+		if (buffer.size() >= WRITE_BUFFER)
 		{
-			count_dot++;
-			if (i == 0)
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-			if (!isdigit(line[i - 1]) || !isdigit(line[i + 1]))
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
+			file.write(buffer.data(), buffer.size());
+			buffer.clear();
 		}
 	}
-	if (count_comma != comma || count_dot > dot)
-		throw Error("Error: " + file + std::string(" is corrupted: wrong number of comma or dot"));
+	file.write(buffer.data(), buffer.size());
+	if (!file.flush())
+		throw Error("Error: couldn't write " + file_name);
 }
 
-static std::vector<std::vector<double>>	read_file(const std::string& dataset)
+// labels are written one-hot, as train expects them
+static void	write_dataset(const std::string& file_name, const Dataset& datas, const std::vector<size_t>& rows, const size_t& value_size)
 {
-	std::ifstream file(dataset);
-	if (!file)
-		throw Error("Error: couldn't open " + dataset);
-	std::vector<std::vector<double>> data;
-	std::string line;
-	size_t count_line = 0;
-	while (getline(file, line))
+	Dataset one_hot(datas.nbr_features(), 2);
+	one_hot.reserve(rows.size());
+	for (const size_t& row : rows)
 	{
-		valid_line(line, 31, 30, dataset, count_line++);
-		std::vector<double> dataline;
-		read_line(line, dataline);
-		data.push_back(dataline);
+		double labels[2] = {1 - *datas.labels(row), *datas.labels(row)};
+		one_hot.push_back(datas.features(row), labels);
 	}
-	file.close();
-	return data;
+	write_binary(file_name, one_hot, LabelEncoding::OneHot, value_size);
 }
 
-static void	normalize_data(std::vector<std::vector<double>>& data)
+/**
+ * @param suffix added to the file names, before the extension
+ * @param value_size 0 to write training.csv and validation.csv, else
+ * training.bin and validation.bin with values of value_size bytes
+ */
+static void	write_split(const Dataset& datas, const SplitIndices& split, const std::string& suffix, const size_t& value_size)
 {
-	size_t nbr_line = data.size();
-	size_t nbr_columns = data[0].size();
-	std::vector<double> mean_coefs(nbr_columns, 0);
-	std::vector<double> max_coef(nbr_columns, 0);
-	for (const auto& line : data)
+	if (value_size == 0)
 	{
-		for (size_t col = 0 ; col < nbr_columns ; col++)
-		{
-			mean_coefs[col] += line[col];
-			max_coef[col] = line[col] > max_coef[col] ? line[col] : max_coef[col];
-		}
-	}
-	for (auto& coef : mean_coefs)
-		coef /= nbr_line;
-	for (auto& line : data)
-	{
-		for (size_t i = 0 ; i < nbr_columns ; i++)
-		{
-			if (i != 0)
-			{
-				line[i] = line[i] == 0 ? mean_coefs[i] : line[i];
-				line[i] /= max_coef[i];
-			}
-		}
+		write_csv("training" + suffix + ".csv", datas, split.training);
+		write_csv("validation" + suffix + ".csv", datas, split.validation);
+		return ;
 	}
+	write_dataset("training" + suffix + ".bin", datas, split.training, value_size);
+	write_dataset("validation" + suffix + ".bin", datas, split.validation, value_size);
 }
 
-static void	split(const int& training_percentage, const std::vector<std::vector<double>>& data)
+int	main(int argc, char **argv)
 {
-	if (training_percentage < 0 || training_percentage > 100)
-		throw Error("Error: training percentage must be between 0 and 100");
-	std::ofstream training_file("training.csv");
-	std::ofstream validation_file("validation.csv");
-	if (!training_file || !validation_file)
-		throw Error("Error: couldn't open training.csv or validation.csv");
-	double train_lines = (double)data.size() * ((double)training_percentage / 100.0);
-	size_t line = 0;
-	std::vector<std::vector<double>> tmp = data;
-	for ( ; line < (size_t)train_lines ; line++)
+	try
 	{
-		size_t random_line = (size_t)random_double(0, tmp.size());
-		for (size_t coef = 0 ; coef < tmp[random_line].size() ; coef++)
+		if (argc < 2)
+			throw Error(USAGE);
+		int training_percentage = -1;
+		size_t folds = 0;
+		bool stratify = false;
+		size_t value_size = 0;
+		for (int i = 1 ; i < argc ; i++)
 		{
-			training_file << tmp[random_line][coef];
-			if (coef == tmp[random_line].size() - 1)
-				training_file << std::endl;
+			std::string flag = argv[i];
+			if (i == 1 && flag.compare(0, 2, "--") != 0)
+				training_percentage = std::atoi(argv[i]);
+			else if (flag == "--stratify")
+				stratify = true;
+			else if (i + 1 >= argc)
+				throw Error(USAGE);
+			else if (flag == "--folds")
+			{
+				int value = std::atoi(argv[++i]);
+				if (value < 2)
+					throw Error("Error: folds must be an integer greater than 1");
+				folds = value;
+			}
+			else if (flag == "--seed")
+			{
+				unsigned long value;
+				try { value = std::stoul(argv[++i]); }
+				catch (...) { throw Error("Error: seed must be a positive integer"); }
+				seed_urng(value);
+			}
+			else if (flag == "--binary")
+			{
+				std::string type = argv[++i];
+				if (type != "float64" && type != "float32")
+					throw Error("Error: binary values are float64 or float32");
+				value_size = type == "float64" ? 8 : 4;
+			}
 			else
-				training_file << ',';
+				throw Error("Error: unknown flag: " + flag);
 		}
-		std::vector<std::vector<double>>::const_iterator it = tmp.begin();
-		size_t count = 0;
-		for ( ; it != tmp.end() && count < random_line ; ++it)
-			count++;
-		tmp.erase(it);
-	}
-	for ( ; tmp.size() ; )
-	{
-		size_t random_line = (size_t)random_double(0, tmp.size());
-		for (size_t coef = 0 ; coef < tmp[random_line].size() ; coef++)
+		if ((training_percentage < 0) == (folds == 0))
+			throw Error(USAGE);
+		if (training_percentage > 100)
+			throw Error("Error: training percentage must be between 0 and 100");
+		Dataset datas = read_csv("data.csv", {1, 30, false, 0});
+		normalize_features(datas);
+		if (folds)
 		{
-			validation_file << tmp[random_line][coef];
-			if (coef == tmp[random_line].size() - 1)
-				validation_file << std::endl;
-			else
-				validation_file << ',';
+			std::vector<SplitIndices> splits = kfold_indices(datas, folds, stratify, global_urng());
+			for (size_t i = 0 ; i < folds ; i++)
+				write_split(datas, splits[i], "_" + std::to_string(i), value_size);
 		}
-		std::vector<std::vector<double>>::const_iterator it = tmp.begin();
-		size_t count = 0;
-		for ( ; it != tmp.end() && count < random_line ; ++it)
-			count++;
-		tmp.erase(it);
-	}
-	training_file.close();
-	validation_file.close();
-}
-
-int	main(int argc, char **argv)
-{
-	try
-	{
-		if (argc != 2)
-			throw Error("Error: ./split <training_percentage>");
-		std::vector<std::vector<double>> data = read_file("data.csv");
-		normalize_data(data);
-		split(std::atoi(argv[1]), data);
+		else
+			write_split(datas, split_indices(datas, training_percentage / 100.0, stratify, global_urng()), "", value_size);
 	}
 	catch (const std::exception& e) { std::cerr << e.what() << std::endl; }
 	return 0;
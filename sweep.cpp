@@ -0,0 +1,118 @@
+#include "ARNetwork/neural_network/include/Sweep.hpp"
+#include "ARNetwork/neural_network/include/Csv.hpp"
+#include <iomanip>
+#include <sstream>
+
+#define USAGE "Error: ./sweep --layers '<layers>[;<layers>...]' [--learning_rates '<rates>' --batches '<batches>' --layer_functions '<functions>' --trials <trials> --min_epoch <epoch> --epoch <epoch> --eta <eta> --split <training_percentage> --threads <threads> --seed <seed>]"
+
+// networks separated by ';', each one in the syntax of --layer of train
+static std::vector<std::vector<size_t>>	get_networks(const std::string& arg)
+{
+	std::vector<std::vector<size_t>> networks;
+	std::stringstream stream(arg);
+	std::string network;
+	while (std::getline(stream, network, ';'))
+		networks.push_back(get_network(network));
+	if (networks.empty())
+		throw Error("Error: layers are missing");
+	return networks;
+}
+
+// space separated values, each one checked by @param valid
+template <typename T, typename V>
+static std::vector<T>	get_values(const std::string& arg, const std::string& name, V valid)
+{
+	std::vector<T> values;
+	std::stringstream stream(arg);
+	T value;
+	while (stream >> value)
+	{
+		if (!valid(value))
+			throw Error("Error: wrong value of " + name);
+		values.push_back(value);
+	}
+	if (!stream.eof() || values.empty())
+		throw Error("Error: wrong value of " + name);
+	return values;
+}
+
+static std::string	layers_name(const std::vector<size_t>& layers)
+{
+	std::string name;
+	for (size_t i = 1 ; i + 1 < layers.size() ; i++)
+		name += (i > 1 ? " " : "") + std::to_string(layers[i]);
+	return name;
+}
+
+static void	display(const std::vector<TrialResult>& results)
+{
+	std::cout << std::left << std::setw(6) << "rank" << std::setw(16) << "layers" << std::setw(15) << "learning_rate" << std::setw(7) << "batch"
+		<< std::setw(11) << "function" << std::setw(8) << "epochs" << std::setw(12) << "loss" << std::setw(12) << "r2" << "status" << std::endl;
+	for (size_t i = 0 ; i < results.size() ; i++)
+	{
+		const TrialResult& result = results[i];
+		std::cout << std::setw(6) << i + 1 << std::setw(16) << layers_name(result.config.layers) << std::setw(15) << result.config.learning_rate
+			<< std::setw(7) << result.config.batch << std::setw(11) << result.config.layer_function << std::setw(8) << result.epochs
+			<< std::setw(12) << result.loss << std::setw(12) << result.r2 << (result.stopped ? "stopped" : "done") << std::endl;
+	}
+}
+
+int	main(int argc, char **argv)
+{
+	try
+	{
+		std::vector<std::vector<size_t>> networks;
+		std::vector<double> learning_rates = {0.1};
+		std::vector<size_t> batches = {1};
+		std::vector<std::string> layer_functions = {"sigmoid"};
+		size_t trials = 0;
+		int training_percentage = 80;
+		SweepSettings settings = {10, 270, 3, std::max(1u, std::thread::hardware_concurrency())};
+		for (int i = 1 ; i + 1 < argc ; i += 2)
+		{
+			std::string flag = argv[i];
+			if (flag == "--layers")
+				networks = get_networks(argv[i + 1]);
+			else if (flag == "--learning_rates")
+				learning_rates = get_values<double>(argv[i + 1], "learning rate", [](const double& value) { return value > 0; });
+			else if (flag == "--batches")
+				batches = get_values<size_t>(argv[i + 1], "batch", [](const size_t& value) { return value > 0; });
+			else if (flag == "--layer_functions")
+				layer_functions = get_values<std::string>(argv[i + 1], "layer function", [](const std::string& value)
+					{ activation_from_name(value); return true; });
+			else if (flag == "--trials")
+				trials = positive_integer("trials", argv[i + 1]);
+			else if (flag == "--min_epoch")
+				settings.min_epochs = positive_integer("min_epoch", argv[i + 1]);
+			else if (flag == "--epoch")
+				settings.max_epochs = positive_integer("epoch", argv[i + 1]);
+			else if (flag == "--eta")
+				settings.eta = positive_integer("eta", argv[i + 1]);
+			else if (flag == "--split")
+				training_percentage = positive_integer("split", argv[i + 1]);
+			else if (flag == "--threads")
+				settings.threads = positive_integer("threads", argv[i + 1]);
+			else if (flag == "--seed")
+			{
+				unsigned long value;
+				try { value = std::stoul(argv[i + 1]); }
+				catch (...) { throw Error("Error: seed must be a positive integer"); }
+				seed_urng(value);
+			}
+			else
+				throw Error("Error: unknown flag: " + flag);
+		}
+		if (networks.empty() || argc % 2 == 0)
+			throw Error(USAGE);
+		if (training_percentage >= 100)
+			throw Error("Error: training percentage must be between 0 and 100");
+		Dataset datas = read_csv("data.csv", {1, 30, true, 0});
+		normalize_features(datas);
+		SplitIndices split = split_indices(datas, training_percentage / 100.0, true, global_urng());
+		std::vector<TrialConfig> configs = trials ? random_configs(networks, learning_rates, batches, layer_functions, trials, global_urng())
+			: grid_configs(networks, learning_rates, batches, layer_functions);
+		display(sweep(configs, datas, split, settings));
+	}
+	catch (const std::exception& e) { std::cerr << e.what() << std::endl; }
+	return 0;
+}
@@ -1,48 +1,32 @@
 #include "ARNetwork/neural_network/include/ARNetwork.hpp"
+#include "ARNetwork/neural_network/include/Csv.hpp"
+#include "ARNetwork/neural_network/include/BinaryDataset.hpp"
+#include "ARNetwork/neural_network/include/ModelFile.hpp"
+#include "ARNetwork/neural_network/include/Split.hpp"
 
-static std::vector<size_t>	get_network(const std::string& arg)
-{
-	std::vector<size_t> layers;
-	layers.push_back(30);
-	for (size_t i = 0 ; i < arg.size() ; i++)
-	{
-		if (!isdigit(arg[i]) && arg[i] != ' ')
-			throw Error("Error: wrong format of layer");
-		if (isdigit(arg[i]))
-		{
-			layers.push_back(std::atoi(arg.c_str() + i));
-			for ( ; i < arg.size() ; i++)
-				if (arg[i] == ' ')
-					break;
-		}
-	}
-	layers.push_back(2);
-	return layers;
-}
+#define USAGE "Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch> --threads <threads> --seed <seed> --chunk <chunk> --prefetch <prefetch> --format <csv|binary> --save <file.json|file.bin> --checkpoint <epochs> --checkpoint_seconds <seconds>]\n       ./train --resume <checkpoint.json> [the same options but --layer]"
 
-static ARNetwork	parse_args(int argc, char **argv, std::string& layer_function, int& epoch, int& batch)
+// where --checkpoint and --checkpoint_seconds save the training
+#define CHECKPOINT_FILE "checkpoint.json"
+
+static ARNetwork	parse_args(int argc, char **argv, std::string& layer_function, int& epoch, int& batch, int& threads, int& chunk, int& prefetch, std::string& format, std::string& save, CheckpointSettings& checkpoint, std::string& resume)
 {
 	if (argc == 1)
-		throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
-	double learning_rate = 0.1;
+		throw Error(USAGE);
+	double learning_rate = 0;
 	std::vector<size_t> network;
 	for (size_t i = 1 ; (int)i < argc && argv[i] ; i += 2)
 	{
 		if (std::string(argv[i]) == "--epoch")
 		{
 			if (!argv[i + 1])
-				throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
-			int value;
-			try { value = std::stoi(argv[i + 1]); }
-			catch (...) { throw Error("Error: epoch must be a non null positive integer"); }
-			if (value <= 0)
-				throw Error("Error: epoch must be a non null positive integer");
-			epoch = value;
+				throw Error(USAGE);
+			epoch = positive_integer("epoch", argv[i + 1]);
 		}
 		else if (std::string(argv[i]) == "--learning_rate")
 		{
 			if (!argv[i + 1])
-				throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
+				throw Error(USAGE);
 			double value;
 			try { value = std::stod(argv[i + 1]); }
 			catch (...) { throw Error("Error: learning rate must be a non null positive double"); }
@@ -53,120 +37,172 @@ static ARNetwork	parse_args(int argc, char **argv, std::string& layer_function,
 		else if (std::string(argv[i]) == "--layer_function")
 		{
 			if (!argv[i + 1])
-				throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
+				throw Error(USAGE);
 			layer_function = argv[i + 1];
 		}
 		else if (std::string(argv[i]) == "--batch")
 		{
 			if (!argv[i + 1])
-				throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
+				throw Error(USAGE);
+			batch = positive_integer("batch", argv[i + 1]);
+		}
+		else if (std::string(argv[i]) == "--threads")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			threads = positive_integer("threads", argv[i + 1]);
+		}
+		else if (std::string(argv[i]) == "--chunk")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			chunk = positive_integer("chunk", argv[i + 1]);
+		}
+		else if (std::string(argv[i]) == "--prefetch")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			prefetch = positive_integer("prefetch", argv[i + 1]);
+		}
+		else if (std::string(argv[i]) == "--format")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			format = argv[i + 1];
+			if (format != "csv" && format != "binary")
+				throw Error("Error: format must be csv or binary");
+		}
+		else if (std::string(argv[i]) == "--save")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			save = argv[i + 1];
+		}
+		else if (std::string(argv[i]) == "--checkpoint")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			checkpoint.epochs = positive_integer("checkpoint", argv[i + 1]);
+			checkpoint.file_name = CHECKPOINT_FILE;
+		}
+		else if (std::string(argv[i]) == "--checkpoint_seconds")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
 			double value;
-			try { value = std::stoi(argv[i + 1]); }
-			catch (...) { throw Error("Error: batch must be a non null positive integer"); }
+			try { value = std::stod(argv[i + 1]); }
+			catch (...) { throw Error("Error: checkpoint_seconds must be a non null positive double"); }
 			if (value <= 0)
-				throw Error("Error: batch must be a non null positive integer");
-			batch = value;
+				throw Error("Error: checkpoint_seconds must be a non null positive double");
+			checkpoint.seconds = value;
+			checkpoint.file_name = CHECKPOINT_FILE;
+		}
+		else if (std::string(argv[i]) == "--resume")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			resume = argv[i + 1];
+		}
+		else if (std::string(argv[i]) == "--seed")
+		{
+			if (!argv[i + 1])
+				throw Error(USAGE);
+			unsigned long value;
+			try { value = std::stoul(argv[i + 1]); }
+			catch (...) { throw Error("Error: seed must be a positive integer"); }
+			seed_urng(value);
 		}
 		else if (std::string(argv[i]) == "--layer")
 		{
 			if (!argv[i + 1])
-				throw Error("Error: ./train --layer '<layers>' [--epoch <epoch> --learning_rate <learning_rate> --layer_function <layer_function> --batch <batch>]");
+				throw Error(USAGE);
 			network = get_network(argv[i + 1]);
 		}
 		else
 			throw Error("Error: unknown flag: " + std::string(argv[i]));
-		if (network.empty())
-			throw Error("Error: layers are missing");
 	}
-	ARNetwork arn(network);
-	arn.set_learning_rate(learning_rate);
+	if (!resume.empty() && !network.empty())
+		throw Error("Error: the layers of a resumed training are those of its checkpoint");
+	if (resume.empty() && network.empty())
+		throw Error("Error: layers are missing");
+	ARNetwork arn = resume.empty() ? ARNetwork(network) : ARNetwork(resume);
+	// a resumed training keeps the learning rate and functions of its checkpoint unless told otherwise
+	if (learning_rate > 0 || resume.empty())
+		arn.set_learning_rate(learning_rate > 0 ? learning_rate : 0.1);
+	if (layer_function.empty())
+		layer_function = resume.empty() ? "sigmoid" : arn.get_layer_function();
+	if ((int)arn.get_epoch() >= epoch)
+		throw Error("Error: " + resume + " is already at epoch " + std::to_string(arn.get_epoch()));
 	return arn;
 }
 
-static void	valid_line(const std::string& line, const size_t& comma, const size_t& dot, const std::string& file, const size_t& index)
-{
-	size_t count_dot = 0;
-	size_t count_comma = 0;
-	for (size_t i = 0 ; i < line.size() ; i++)
-	{
-		if (!isdigit(line[i]) && line[i] != ',' && line[i] != '.' && line[i] != 'M' && line[i] != 'B')
-			throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-		if (line[i] == ',')
-		{
-			count_comma++;
-			if (i == 0)
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-			if ((!isdigit(line[i - 1]) && line[i - 1] != 'M' && line[i - 1] != 'B') || (!isdigit(line[i + 1]) && line[i - 1] != 'M' && line[i - 1] != 'B'))
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-		}
-		if (line[i] == '.')
-		{
-			count_dot++;
-			if (i == 0)
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-			if (!isdigit(line[i - 1]) || !isdigit(line[i + 1]))
-				throw Error("Error: " + file + std::string(" is corrupted: line " + index) + std::string(" column " + i));
-		}
-	}
-	if (count_comma != comma || count_dot > dot)
-		throw Error("Error: " + file + std::string(" is corrupted: wrong number of comma or dot"));
-}
-
-static std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>>	extract_datas(const std::string& csv)
-{
-	std::ifstream file(csv);
-	if (!file)
-		throw Error("Error: couldn't open " + csv);
-	std::string line;
-	std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>> datas;
-	size_t count_line = 0;
-	while (getline(file, line))
-	{
-		std::vector<double> output;
-		std::vector<double> input;
-		valid_line(line, 30, 30, csv, count_line++);
-		for (size_t i = 0 ; i < line.size() ; i++)
-		{
-			int malin;
-			if (i == 0)
-			{
-				malin = std::atof(line.c_str());
-				if (malin != 1 && malin != 0)
-					throw Error("Error: " + csv + std::string(" is corrupted"));
-				if (malin)
-					output = {0.0, 1.0};
-				else
-					output = {1.0, 0.0};
-			}
-			if (line[i - 1] == ',')
-				input.push_back(std::atof(line.c_str() + i));
-		}
-		datas.first.push_back(input);
-		datas.second.push_back(output);
-	}
-	return datas;
-}
-
 int	main(int argc, char **argv)
 {
 	try
 	{
 		int epoch = 1000;
 		int batch = 1;
-		std::string layer_function = "sigmoid";
-		ARNetwork arn = parse_args(argc, argv, layer_function, epoch, batch);
-		arn.randomize_bias(0, -sqrt(6 / 43), sqrt(6 / 43));
-		arn.randomize_weights(0, -sqrt(6 / 43), sqrt(6 / 43));
-		arn.randomize_bias(1, -sqrt(6 / 24), sqrt(6 / 24));
-		arn.randomize_weights(1, -sqrt(6 / 24), sqrt(6 / 24));
-		arn.randomize_bias(2, -sqrt(6 / 10), sqrt(6 / 10));
-		arn.randomize_weights(2, -sqrt(6 / 10), sqrt(6 / 10));
-		std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>> train_datas = extract_datas("training.csv");
-		std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>> validation_datas = extract_datas("validation.csv");
-		std::pair<std::map<size_t, std::pair<double, double>>, std::map<size_t, std::pair<double, double>>> tracking = arn.train("bce", layer_function, "softmax", {ARNetwork::batching(train_datas.first, batch), ARNetwork::batching(validation_datas.first, batch)}, {ARNetwork::batching(train_datas.second, batch), ARNetwork::batching(validation_datas.second, batch)}, epoch);
-		arn.get_json("model.json");
+		int threads = 1;
+		int chunk = 0;
+		int prefetch = 2;
+		std::string layer_function;
+		std::string format = "csv";
+		std::string save = "model.json";
+		CheckpointSettings checkpoint = {"", 0, 0};
+		std::string resume;
+		ARNetwork arn = parse_args(argc, argv, layer_function, epoch, batch, threads, chunk, prefetch, format, save, checkpoint, resume);
+		// set on the network kept, a copy of it doesn't checkpoint
+		arn.set_checkpoint(checkpoint);
+		if (resume.empty())
+		{
+			arn.randomize_bias(0, -sqrt(6 / 43), sqrt(6 / 43));
+			arn.randomize_weights(0, -sqrt(6 / 43), sqrt(6 / 43));
+			arn.randomize_bias(1, -sqrt(6 / 24), sqrt(6 / 24));
+			arn.randomize_weights(1, -sqrt(6 / 24), sqrt(6 / 24));
+			arn.randomize_bias(2, -sqrt(6 / 10), sqrt(6 / 10));
+			arn.randomize_weights(2, -sqrt(6 / 10), sqrt(6 / 10));
+		}
+		else
+			arn.restore_urng();
+		// --epoch is the total, a resumed training only runs the epochs its checkpoint misses
+		epoch -= arn.get_epoch();
+		std::pair<std::map<size_t, std::pair<double, double>>, std::map<size_t, std::pair<double, double>>> tracking;
+		if (chunk && format == "binary")
+		{
+			BinarySource train_datas("training.bin");
+			BinarySource validation_datas("validation.bin");
+			tracking = arn.train("bce", layer_function, "softmax", train_datas, validation_datas, batch, epoch, threads, chunk, prefetch);
+		}
+		else if (chunk)
+		{
+			// streaming: only a few chunks of examples are in memory at once
+			CsvSource train_datas("training.csv", {0, 30, true, 0});
+			CsvSource validation_datas("validation.csv", {0, 30, true, 0});
+			tracking = arn.train("bce", layer_function, "softmax", train_datas, validation_datas, batch, epoch, threads, chunk, prefetch);
+		}
+		else if (format == "binary")
+		{
+			// the mapped files are used in place
+			BinaryDataset train_datas("training.bin");
+			BinaryDataset validation_datas("validation.bin");
+			tracking = arn.train("bce", layer_function, "softmax", train_datas.view(), validation_datas.view(), batch, epoch, threads);
+		}
+		else
+		{
+			Dataset train_datas = read_csv("training.csv", {0, 30, true, 0});
+			Dataset validation_datas = read_csv("validation.csv", {0, 30, true, 0});
+			tracking = arn.train("bce", layer_function, "softmax", train_datas, validation_datas, batch, epoch, threads);
+		}
+		// a .bin model is mapped by prediction instead of being parsed
+		if (save.size() >= 4 && save.compare(save.size() - 4, 4, ".bin") == 0)
+			write_model(save, arn);
+		else
+			arn.get_json(save);
 		for (const auto& track : tracking.first)
 			std::cout << track.first << " loss = " << track.second.first << " r2 = " << track.second.second << std::endl;
+#ifdef ARN_COUNT_ALLOCATIONS
+		std::cerr << "allocations after the first epoch: " << arn.steady_state_allocations() << std::endl;
+#endif
 	}
 	catch (const std::exception& e) { std::cerr << e.what() << std::endl; }
 	return 0;